@@ -135,8 +135,13 @@ int main(int argc, char* const* argv)
 
     toLower(outFolderLower);
 
+    if (!RS_CONFIG.exists("versionid"))
+    {
+        ERROR("'versionid' is not specified in redscript config.");
+        return EXIT_FAILURE;
+    }
     // mc_program endProgram = tomc(bytecode, removeSpecialCharacters(outFolderLower), conversionError);
-    mc_program endProgram = tomc(bytecode, "redscript", conversionError);
+    mc_program endProgram = tomc(bytecode, "redscript", conversionError, mc_target::base());
 
     if (!conversionError.empty())
     {
@@ -152,6 +157,23 @@ int main(int argc, char* const* argv)
         ERROR("Error while writing: %s", conversionError.c_str());
         return EXIT_FAILURE;
     }
+    // newer versions load the overlay of their range instead, compiled with what they support.
+    for (const mc_target& target : mc_target::overlays())
+    {
+        INFO("Compiling overlay for pack format %d...", target.packFormat);
+        mc_program overlay = tomc(bytecode, "redscript", conversionError, target);
+        if (!conversionError.empty())
+        {
+            ERROR("%s", conversionError.c_str());
+            return EXIT_FAILURE;
+        }
+        writemc(overlay, packageName, outFolderLower, conversionError, MC_OVERLAY_DIRECTORY(target.packFormat));
+        if (!conversionError.empty())
+        {
+            ERROR("Error while writing: %s", conversionError.c_str());
+            return EXIT_FAILURE;
+        }
+    }
     SUCCESS("Compiled successfully to %s.", outFolder);
     return EXIT_SUCCESS;
 }
\ No newline at end of file
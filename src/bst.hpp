@@ -65,6 +65,7 @@ inline int operatorPrecedence(bst_operation_type ot)
 {
     switch(ot)
     {
+        case bst_operation_type::POW:
         case bst_operation_type::XOR:
             return 0;
         case bst_operation_type::MOD:
@@ -121,6 +122,18 @@ inline _T operator_compute(_T left, bst_operation_type op, _T right)
                 return left % right;
             }
             break;
+        case ot::POW:
+            if constexpr (std::is_integral_v<_T>)
+            {
+                if (right < 0)
+                    break;
+                _T result = 1;
+                for (; right > 0; right >>= 1, left *= left)
+                    if (right & 1)
+                        result *= left;
+                return result;
+            }
+            break;
     }
     return left;
 }
@@ -189,7 +202,7 @@ struct bst_operation
                 operation = bst_operation_type::MOD;
                 break;
             case '^':
-                operation = bst_operation_type::XOR;
+                operation = bst_operation_type::POW;
                 break;
             default:
                 return false;
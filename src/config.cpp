@@ -35,7 +35,8 @@ rs_config readConfig(const std::string& path, rs_error* err)
         else             value = content.substr(iter + 1, end - iter + 1);
         if (value.back() == '\n')
             value.pop_back();
-        if (std::isdigit(value.at(0)))
+        // lists (`overlays=18,26`) are kept as strings.
+        if (std::isdigit(value.at(0)) && value.find(',') == std::string::npos)
         {
             try{
                 config.dict.insert_or_assign(flag, std::stoi(value));
@@ -6,8 +6,69 @@
 #define RS_STRING_KW_ID 4
 #define RS_LIST_KW_ID 5
 #define RS_OBJECT_KW_ID 6
+#define RS_SELECTOR_KW_ID 7
+#define RS_MAP_KW_ID 8
+// a handle to a slot of the heap, an int.
+#define RS_REF_KW_ID 9
 #define RS_ANY_KW_ID 0
 
+// functions whose (selector) argument can be casted to an object type using DOP.
+#define RS_ENTITY_SOURCE_FUNCTION "get_player"
+// marks an object type whose members are kept on the scoreboard, one objective each.
+#define RS_SCOREBOARD_OBJECT "scoreboard"
+
+// estimated cost (in commands) of calling a function with `function ... with`.
+// a macro call copies its argument compound and instantiates every `$` line of the callee.
+#define RS_MACRO_CALL_COST 4
+#define RS_MACRO_LINE_COST 1
+// a value read from storage can't be placed inside a command (i.e. a selector), so that use has no storage cost.
+#define RS_STORAGE_COMMAND_COST UINT32_MAX
+
+// minimum instruction count of an if/else block moved into its own function, overridden by `outline` in rs.config.
+#define RS_OUTLINE_THRESHOLD 8
+// outlined blocks are named after their function, `<function>_b<n>`.
+#define RS_OUTLINED_GLOBAL_NAME "_main"
+// runs the program's setup from the load tag.
+#define RS_INIT_FUNCTION_NAME "_init"
+// runs queued jobs from the tick tag, `<name>_run` takes one job and `<name>_j<id>` starts a job of that function.
+#define RS_SCHEDULER_FUNCTION_NAME "_scheduler"
+// estimated commands the scheduler may spend on jobs every tick, overridden by `scheduler_budget` in rs.config.
+#define RS_SCHEDULER_BUDGET 1000
+
+// the math library works in fixed point, `math::sin(90000)` (90°) is 1000.
+#define RS_MATH_SCALE 1000
+// floats are fixed point on the scoreboard, `float` is `float<RS_FLOAT_SCALE>`.
+#define RS_FLOAT_SCALE 1000
+// its functions are generated under `_math/`, only the ones the program uses.
+#define RS_MATH_DIRECTORY "_math"
+// the macros copying list elements at a variable index, `_list/get` and `_list/set`.
+#define RS_LIST_DIRECTORY "_list"
+// map operations with a key only known at runtime, `_map/set`, `_map/get`, ...
+#define RS_MAP_DIRECTORY "_map"
+#define RS_MAP_VALUES "values"
+#define RS_MAP_ENTRIES "entries"
+// allocation and access of heap slots, `_heap/new`, `_heap/get`, ...
+#define RS_HEAP_DIRECTORY "_heap"
+// the item of a for loop over an object, its members being the name and value of each member (see rslib/lang.rsc).
+#define RS_FOR_PAIR_TYPE "pair"
+#define RS_FOR_PAIR_NAME "i1"
+#define RS_FOR_PAIR_VALUE "i2"
+
+// a selector used this many times by a function is tagged once, before the first of them.
+#define RS_SELECTOR_CACHE_USES 2
+// intrinsics that can kill or change entities, the uses of a selector on either side of them aren't cached together.
+#define RS_ENTITY_CHANGING_INTRINSICS {"kill", "data_copy", "store_result", "store_success"}
+
+// if/elif chains on one int with at least this many cases are dispatched on its score.
+#define RS_DISPATCH_MIN_CASES 4
+// cases tested one by one at the bottom of a dispatch tree.
+#define RS_DISPATCH_LEAF_CASES 2
+// share of the values in range that must have a case for a jump table.
+#define RS_JUMP_TABLE_DENSITY 0.5
+
+// multiplications by 2^n up to this n are done by adding a register to itself, without a pooled constant.
+#define RS_MAX_DOUBLING_ADDS 1
+
 #define RS_LANG_KEYWORDS {{"true", {token_type::KW_TRUE,0}}, \
     {"false", {token_type::KW_FALSE,0}}, \
     {"int", {token_type::TYPE_DEF, 1}}, \
@@ -17,6 +78,8 @@
     {"list", {token_type::TYPE_DEF, 5}}, \
     {"object", {token_type::TYPE_DEF, 6}}, \
     {"selector", {token_type::TYPE_DEF, 7}}, \
+    {"map", {token_type::TYPE_DEF, 8}}, \
+    {"ref", {token_type::TYPE_DEF, 9}}, \
     {"any", {token_type::TYPE_DEF, 0}}, \
     {"void", {token_type::TYPE_DEF, -1}}, \
     {"return", {token_type::KW_RETURN,0}}, \
@@ -31,6 +94,8 @@
     {"break", {token_type::KW_BREAK,0}}, \
     {"in", {token_type::KW_IN,0}}, \
     {"continue", {token_type::KW_CONTINUE,0}}, \
+    {"yield", {token_type::KW_YIELD,0}}, \
+    {"await", {token_type::KW_AWAIT,0}}, \
     {"use", {token_type::KW_USE,0}}, \
     {"if", {token_type::KW_IF,0}}, \
     {"else", {token_type::KW_ELSE,0}}, \
@@ -38,6 +103,8 @@
     {"or", {token_type::KW_OR,0}}, \
     {"not", {token_type::KW_NOT,0}}, \
     {"and", {token_type::KW_AND,0}}, \
+    {"as", {token_type::KW_AS,0}}, \
+    {"at", {token_type::KW_AT,0}}, \
     {"null", {token_type::KW_NULL,0}}, \
     {"asm", {token_type::KW_ASM,0}}}
 
@@ -9,16 +9,39 @@
 #define RS_PROGRAM_STACK     "stack"
 #define RS_PROGRAM_DATA      "_internal"
 #define RS_PROGRAM_VARIABLES "variables"
+#define RS_PROGRAM_SLOTS      "v" // variables with the flat storage layout
+#define RS_PROGRAM_SLOT_TYPES "t"
 #define RS_PROGRAM_REGISTERS "registers"
 #define RS_PROGRAM_RETURN_REGISTER "ret"
 #define RS_PROGRAM_RETURN_TYPE_REGISTER "ret_type"
+#define RS_PROGRAM_ARGS "args"
+#define RS_PROGRAM_ASYNC "async"
+#define RS_PROGRAM_JOBS "jobs"
+#define RS_PROGRAM_MATH "math"
+#define RS_PROGRAM_ELEMENTS "elements"
+#define RS_PROGRAM_HEAP "heap"
+#define RS_PROGRAM_HEAP_FREE "heap_free" // ids of the freed slots, taken again before new ones
+#define RS_PROGRAM_TERMS "terms" // list values copied out for a condition to filter, terms.t<n>
 #define RBC_REGISTER_PLAYER "_CPU"
 #define RBC_REGISTER_PLAYER_OBJ "alu"
 #define RBC_COMPARISON_RESULT_REGISTER "cmp"
+#define RBC_PARAMETER_OBJ "args"
+#define RBC_CONSTANT_OBJ "const"
+#define RBC_DEBUG_OBJ "rs_debug"
+#define RBC_SCHEDULER_OBJ "rs_sched"
+#define RBC_MATH_OBJ "rs_math"
+#define RBC_HEAP_OBJ "rs_heap"
+#define RBC_SELECTOR_TAG "rs_sel"
 #define MC_DATAPACK_FOLDER "datapacks"
 #define MC_MCMETA_FILE_NAME "pack.mcmeta"
+// first pack format of each mc_feature.
+#define MC_STRING_SLICE_PACK_FORMAT 12         // 1.19.4
+#define MC_RETURN_PACK_FORMAT 15               // 1.20
+#define MC_MACRO_PACK_FORMAT 18                // 1.20.2, also return run, random and overlays
+#define MC_EXECUTE_IF_FUNCTION_PACK_FORMAT 26  // 1.20.3
 #define MC_TEMP_STORAGE_NAME "temp"
 
-#define RS_PROGRAM_DATA_DEFAULT "{\"" RS_PROGRAM_VARIABLES "\":[], \"" RS_PROGRAM_REGISTERS "\":[], \"" RS_PROGRAM_DATA "\":{}, \"" RS_PROGRAM_STACK "\":[], \"" RS_PROGRAM_RETURN_REGISTER "\": 0, \"temp\": 0}"
+// variables are the global variables' compounds, slots holds the flat layout's compounds.
+#define RS_PROGRAM_DATA_DEFAULT(variables, slots) "{\"" RS_PROGRAM_VARIABLES "\":[" INS(variables) "], \"" RS_PROGRAM_REGISTERS "\":[], \"" RS_PROGRAM_DATA "\":{}, \"" RS_PROGRAM_STACK "\":[], \"" RS_PROGRAM_RETURN_REGISTER "\": 0, \"temp\": 0" INS(slots) "}"
 
 inline rs_config RS_CONFIG;
\ No newline at end of file
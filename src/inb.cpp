@@ -2,6 +2,7 @@
 #include "rbc.hpp"
 #include "lang.hpp"
 #include "mchelpers.hpp"
+#include "constants.hpp"
 
 // for readability
 #ifndef INB_IMPL_PARAMETERS
@@ -9,64 +10,484 @@
 #endif
 
 #define IMPL_ERROR(msg) {err=msg " (impl errors do not have trace as of beta, check function calls)"; return;}
+
+// a selector literal, or a selector parameter passed as a macro argument which makes the command a macro line.
+static bool selectorArgument(rbc_value& val, std::string& selector, bool& macro)
+{
+    macro = false;
+    if (val.index() == 0)
+    {
+        rbc_constant& c = std::get<0>(val);
+        selector = c.val;
+        return c.val_type == token_type::SELECTOR_LITERAL;
+    }
+    if (val.index() == 2)
+    {
+        rs_variable& var = *std::get<2>(val);
+        macro    = var.comp_info.macro;
+        selector = MC_MACRO(var.name);
+        return macro;
+    }
+    return false;
+}
+// inbuilt functions are given string literals without their quotes.
+static const std::string& stringArgument(rbc_value& val)
+{
+    return std::get<0>(val).val;
+}
+// copies an int argument into a score holder, false if it isn't one.
+static bool setScore(conversion::CommandFactory& factory, const std::string& holder, rbc_value& val)
+{
+    switch(val.index())
+    {
+        case 0:
+            factory.create_and_push(MC_SCOREBOARD_CMD_ID, MC_SCORE_SET(holder, std::get<0>(val).val));
+            return true;
+        case 1:
+        {
+            rbc_register& reg = *std::get<1>(val);
+            if (reg.operable)
+                factory.create_and_push(MC_SCOREBOARD_CMD_ID, MC_SCORE_COPY(holder, MC_OPERABLE_REG(INS_L(STR(reg.id)))));
+            else
+                factory.add(conversion::CommandFactory::getRegisterValue(reg).storeResult(PADR(score) INS_L(holder)));
+            return true;
+        }
+        case 2:
+        {
+            rs_variable& var = *std::get<2>(val);
+            if (var.comp_info.scoreboard)
+                factory.create_and_push(MC_SCOREBOARD_CMD_ID, MC_SCORE_COPY(holder, factory.variablePath(var)));
+            else
+                factory.add(factory.getVariableValue(var).storeResult(PADR(score) INS_L(holder)));
+            return true;
+        }
+        default:
+            return false;
+    }
+}
+// a math library call: folded when every argument is a literal, otherwise the inputs are set and the
+// generated function is called, see CommandFactory::mathLibrary.
+static void mathCall(const std::string& name, const std::vector<std::string>& inputs, INB_IMPL_PARAMETERS)
+{
+    bool literals = true;
+    for (rbc_value& val : parameters)
+        literals = literals && val.index() == 0;
+    if (literals)
+    {
+        const int a = std::stoi(std::get<0>(parameters.at(0)).val);
+        const int b = parameters.size() > 1 ? std::stoi(std::get<0>(parameters.at(1)).val) : 0;
+        factory.returnConstant(mc_math_fold(name, a, b));
+        return;
+    }
+    // the tables are read with a macro index.
+    if (!factory.supports(mc_feature::MACROS))
+        IMPL_ERROR("impl::math: the math library needs function macros, which the target version doesn't support.");
+    for (size_t i = 0; i < inputs.size(); i++)
+        if (!setScore(factory, inputs.at(i), parameters.at(i)))
+            IMPL_ERROR("impl::math: expected an int value.");
+    factory.returnResult(mc_command(false, MC_FUNCTION_CMD_ID, factory.useMath(name)));
+}
+// the end of a data modify writing an element: `value 4`, or `from storage ...` for a value only known at runtime.
+// scores are stored in the temp storage first.
+static std::string elementSource(conversion::CommandFactory& factory, rbc_value& val, const rs_type_info& element)
+{
+    const bool fixed = conversion::CommandFactory::fixedScale(element) != 1;
+    switch(val.index())
+    {
+        case 0:
+        {
+            rbc_constant c = std::get<0>(val);
+            c.quoteIfStr();
+            // the elements of a float list are doubles.
+            if (fixed && c.val_type == token_type::INT_LITERAL)
+                c.val += ".0";
+            return "value " + (c.val_type == token_type::SELECTOR_LITERAL ? c.quoted() : c.val);
+        }
+        case 1:
+        {
+            rbc_register& reg = *std::get<1>(val);
+            if (!reg.operable)
+                return "from storage " RS_PROGRAM_STORAGE SEP ARR_AT(RS_PROGRAM_REGISTERS, STR(reg.id));
+            factory.add(conversion::CommandFactory::storeRegister(reg, MC_TEMP_STORAGE_NAME, fixed));
+            return "from storage " MC_TEMP_STORAGE;
+        }
+        case 2:
+        {
+            rs_variable& var = *std::get<2>(val);
+            if (!var.comp_info.scoreboard)
+                return "from storage " RS_PROGRAM_STORAGE SEP + factory.variablePath(var);
+            factory.add(factory.getVariableValue(var).storeResult(PADR(storage) MC_TEMP_STORAGE, fixed ? "double" : "int", 1));
+            return "from storage " MC_TEMP_STORAGE;
+        }
+        default:
+            return "";
+    }
+}
+// one data modify on the list: `append`, `prepend`, `insert <i>` or `[] set` (every element).
+static void listModify(const std::string& mode, rbc_value& value, INB_IMPL_PARAMETERS)
+{
+    rs_variable& list = *std::get<2>(parameters.at(0));
+    rs_type_info element = list.type_info;
+    element.array_count = element.array_count ? element.array_count - 1 : 0;
+    const std::string source = elementSource(factory, value, element);
+    if (source.empty())
+        IMPL_ERROR("impl::lists: unsupported element value.");
+    factory.create_and_push(MC_DATA_CMD_ID, MC_DATA(modify storage, INS_L(factory.variablePath(list))) + mode + SEP + source);
+}
+// a map operation. with a literal key its commands are written in place, otherwise the map's path, the key and
+// the value are copied to args.map and `_map/<op>` is called with them. the number of commands is fixed either way.
+static void mapCall(const std::string& op, INB_IMPL_PARAMETERS)
+{
+    rs_variable& map = *std::get<2>(parameters.at(0));
+    rbc_value& key   = parameters.at(1);
+    rbc_value* value = parameters.size() > 2 ? &parameters.at(2) : nullptr;
+    const rs_type_info element = map.type_info.arguments.size() > 1 ? map.type_info.arguments.at(1) : rs_type_info{};
+    const std::string path = factory.variablePath(map);
+
+    mccmdlist commands;
+    if (key.index() == 0)
+    {
+        const std::string source = value ? elementSource(factory, *value, element) : "";
+        commands = conversion::CommandFactory::mapCommands(op, path, mc_escape_string(std::get<0>(key).val), source, false);
+    }
+    else
+    {
+        if (!factory.supports(mc_feature::MACROS))
+            IMPL_ERROR("impl::maps: a key known at runtime needs function macros, which the target version doesn't support.");
+        // a constant value is passed with the path.
+        std::string arguments = "map:\"" + path + "\"";
+        if (value && value->index() == 0)
+            arguments += ",v:" + elementSource(factory, *value, element).substr(std::string("value ").size());
+        factory.create_and_push(MC_DATA_CMD_ID, MC_DATA(modify storage, MC_MAP_ARGUMENTS) PAD(set value) "{" + arguments + "}");
+        factory.create_and_push(MC_DATA_CMD_ID, MC_DATA(modify storage, MC_MAP_ARGUMENTS) ".key set " + elementSource(factory, key, rs_type_info{}));
+        if (value && value->index() != 0)
+            factory.create_and_push(MC_DATA_CMD_ID, MC_DATA(modify storage, MC_MAP_ARGUMENTS) ".v set " + elementSource(factory, *value, element));
+        commands = {mc_command(false, MC_FUNCTION_CMD_ID, factory.useMap(op) + MC_FUNCTION_WITH(MC_MAP_ARGUMENTS))};
+    }
+    if (op == "has")
+    {
+        factory.returnResult(commands.front());
+        return;
+    }
+    for (mc_command& cmd : commands)
+        factory.add(cmd);
+    if (op == "get")
+        factory.create_and_push(MC_DATA_CMD_ID, MC_DATA(modify storage, RS_PROGRAM_RETURN_TYPE_REGISTER) PAD(set value) INS_L(STR(element.type_id)));
+}
+// an inline object as SNBT, its members have to be constants: heap::new({x: 1, tag: "a"}). empty if one isn't.
+static std::string objectLiteral(rs_object& obj)
+{
+    std::string members;
+    for (auto& [name, member] : obj.members)
+    {
+        if (!member.first.value)
+            return "";
+        rs_expression& value = *member.first.value;
+        std::string literal;
+        if (value.nonOperationalResult && value.nonOperationalResult->index() == 3)
+            literal = objectLiteral(*std::get<3>(*value.nonOperationalResult));
+        else if (!value.nonOperationalResult && value.operation.isSingular())
+        {
+            token& t = std::get<token>(*value.operation.left);
+            if (t.type == token_type::WORD)
+                return "";
+            rbc_constant c(t.type, t.repr);
+            c.quoteIfStr();
+            literal = c.val;
+        }
+        if (literal.empty())
+            return "";
+        members += (members.empty() ? "" : ",") + name + ":" + literal;
+    }
+    return "{" + members + "}";
+}
+// the value the next `_heap/set` writes, args.heap.v.
+static void heapValue(rbc_value& value, INB_IMPL_PARAMETERS)
+{
+    std::string source;
+    if (value.index() == 3)
+    {
+        const std::string literal = objectLiteral(*std::get<3>(value));
+        if (!literal.empty())
+            source = "value " + literal;
+    }
+    else
+        source = elementSource(factory, value, rs_type_info{});
+    if (source.empty())
+        IMPL_ERROR("impl::heap: unsupported value, the members of an object have to be constants.");
+    factory.create_and_push(MC_DATA_CMD_ID, MC_DATA(modify storage, MC_HEAP_ARGUMENTS) ".v set " + source);
+}
 namespace inb_impls
 {
-    // technically tellraw impl.
+    // technically tellraw impl. all the arguments after the selector are folded into one message.
     void msg(INB_IMPL_PARAMETERS)
     {
-        // TODO: tellraw
-        rbc_value& selector = parameters.at(0);
-        if (selector.index() != 0)
-        {
-        fail:
+        std::string selector;
+        bool macro;
+        if (!selectorArgument(parameters.at(0), selector, macro))
             IMPL_ERROR("Expected selector as argument 0 for candidate (tellraw) impl::msg.");
-        }
-        rbc_constant& _const = std::get<0>(selector);
-        if (_const.val_type != token_type::SELECTOR_LITERAL)
-            goto fail;
 
-        rbc_value& val = parameters.at(1);
-        switch(val.index())
+        std::vector<mc_text> parts;
+        for (size_t i = 1; i < parameters.size(); i++)
         {
-            case 0:
+            rbc_value& val = parameters.at(i);
+            switch(val.index())
             {
-                rbc_constant& c = std::get<0>(val);
-                
-                factory.create_and_push(MC_TELLRAW_CMD_ID, MC_TELLRAW_CONST(_const.val, c.val));
-                break;
+                case 0:
+                {
+                    rbc_constant& c = std::get<0>(val);
+                    if (c.val_type == token_type::SELECTOR_LITERAL)
+                        parts.push_back({false, MC_TEXT_SELECTOR(c.val)});
+                    else
+                        parts.push_back({true, c.val});
+                    break;
+                }
+                case 1:
+                {
+                    rbc_register& reg = *std::get<1>(val);
+                    parts.push_back({false, reg.operable ? MC_TEXT_SCORE(MC_OPERABLE_REG(INS_L(STR(reg.id))))
+                                                         : MC_TEXT_NBT(ARR_AT(RS_PROGRAM_REGISTERS, STR(reg.id)))});
+                    break;
+                }
+                case 2:
+                {
+                    rs_variable& var = *std::get<2>(val);
+                    // selector parameters passed as macro arguments are resolved by the game.
+                    if (var.comp_info.macro && var.type_info.type_id == RS_SELECTOR_KW_ID)
+                    {
+                        parts.push_back({false, MC_TEXT_SELECTOR(MC_MACRO(var.name))});
+                        macro = true;
+                        break;
+                    }
+                    const std::string path = factory.variablePath(var);
+                    parts.push_back({false, var.comp_info.scoreboard ? MC_TEXT_SCORE(path) : MC_TEXT_NBT(path)});
+                    break;
+                }
+                default:
+                    IMPL_ERROR("tellraw does not accept these parameter types in this version.");
             }
-            case 1:
-            {
-                WARN("Non implemented tellraw functionality.");
-                break;
-            }
-            case 2:
-            {
-                rs_variable& var = *std::get<2>(val);
-                factory.create_and_push(MC_TELLRAW_CMD_ID, MC_TELLRAW_VARIABLE(_const.val, var.comp_info.varIndex));
-                break;
-            }
-            default:
-                IMPL_ERROR("tellraw does not accept these parameter types in this version.");
         }
-        
+        factory.message(selector, parts, macro);
     }
     void kill(INB_IMPL_PARAMETERS)
     {
-        rbc_value& selector = parameters.at(0);
-        if (selector.index() != 0)
-        {
-        fail:
-            IMPL_ERROR("Expected selector as argument 0 for candidate (tellraw) impl::msg.");
-        }
-        rbc_constant& _const = std::get<0>(selector);
-        if (_const.val_type != token_type::SELECTOR_LITERAL)
-            goto fail;
+        std::string selector;
+        bool macro;
+        if (!selectorArgument(parameters.at(0), selector, macro))
+            IMPL_ERROR("Expected selector as argument 0 for candidate impl::kill.");
 
-        factory.create_and_push(MC_KILL_CMD_ID, MC_KILL(_const.val));
+        mc_command cmd{macro, MC_KILL_CMD_ID, MC_KILL(selector)};
+        factory.add(cmd);
     }
-    void compile_assert(INB_IMPL_PARAMETERS)
+    // copies the whole entity NBT, prefer casting it to an object type (see DOP in examples/docs/objects.md).
+    void get_player(INB_IMPL_PARAMETERS)
     {
-        err = "Thise inbuilt function is not implemented yet.";
+        std::string selector;
+        bool macro;
+        if (!selectorArgument(parameters.at(0), selector, macro))
+            IMPL_ERROR("Expected selector as argument 0 for candidate impl::get_player.");
+
+        mc_command cmd{macro, MC_DATA_CMD_ID, MC_DATA(modify storage, RS_PROGRAM_RETURN_REGISTER) PADL(set from) SEP MC_ENTITY(selector)};
+        factory.add(cmd);
+    }
+    // queues a call of the named function, run by the scheduler on this tick or a later one (see rslib/scheduler.rsc).
+    void enqueue(INB_IMPL_PARAMETERS)
+    {
+        auto found = program.functions.find(stringArgument(parameters.at(0)));
+        if (found == program.functions.end())
+            IMPL_ERROR("impl::enqueue: unknown job function.");
+        // the argument is written to the job's parameter slot, which recursive functions don't have.
+        rbc_function& func = *found->second;
+        if (func.parameters.size() != 1 || func.recursive)
+            IMPL_ERROR("impl::enqueue: a job has to take exactly one parameter and can't be recursive.");
+
+        factory.enqueue(func, parameters.at(1));
+    }
+    // the value of a score, `score_get("#timer", "game")`.
+    void score_get(INB_IMPL_PARAMETERS)
+    {
+        const std::string holder = stringArgument(parameters.at(0)) + SEP + stringArgument(parameters.at(1));
+        factory.returnResult(mc_command(false, MC_SCOREBOARD_CMD_ID, PADR(players get) INS_L(holder)));
+    }
+    void score_set(INB_IMPL_PARAMETERS)
+    {
+        const std::string holder = stringArgument(parameters.at(0)) + SEP + stringArgument(parameters.at(1));
+        if (!setScore(factory, holder, parameters.at(2)))
+            IMPL_ERROR("impl::score_set: expected an int value.");
+    }
+    // copies nbt between two data sources, `data_copy("entity @s Motion", "storage game:physics wind")`.
+    void data_copy(INB_IMPL_PARAMETERS)
+    {
+        factory.create_and_push(MC_DATA_CMD_ID, MC_DATA_COPY(stringArgument(parameters.at(0)), stringArgument(parameters.at(1))));
+    }
+    // the result and success of a command, `execute store` into the return value.
+    void store_result(INB_IMPL_PARAMETERS)
+    {
+        factory.returnResult(mc_command(false, MC_EXEC_CMD_ID, PADL(run) SEP INS_L(stringArgument(parameters.at(0)))));
+    }
+    void store_success(INB_IMPL_PARAMETERS)
+    {
+        factory.returnResult(mc_command(false, MC_EXEC_CMD_ID, PADL(run) SEP INS_L(stringArgument(parameters.at(0)))), false);
+    }
+    // a random number between min and max, both included.
+    void random(INB_IMPL_PARAMETERS)
+    {
+        if (!factory.supports(mc_feature::RANDOM))
+            IMPL_ERROR("impl::random: the random command isn't supported by the target version.");
+        const std::string& min = std::get<0>(parameters.at(0)).val;
+        const std::string& max = std::get<0>(parameters.at(1)).val;
+        factory.returnResult(mc_command(false, MC_RANDOM_CMD_ID, MC_RANDOM_VALUE(min, max)));
+    }
+    // runs a function of the program after a number of ticks, `schedule("respawn", 20)`.
+    void schedule(INB_IMPL_PARAMETERS)
+    {
+        auto found = program.functions.find(stringArgument(parameters.at(0)));
+        if (found == program.functions.end())
+            IMPL_ERROR("impl::schedule: unknown function.");
+        // nothing is left to pass its arguments in by the time it runs.
+        rbc_function& func = *found->second;
+        if (!func.parameters.empty())
+            IMPL_ERROR("impl::schedule: a scheduled function can't take parameters.");
+        const std::string& ticks = std::get<0>(parameters.at(1)).val;
+        factory.schedule(func, ticks);
+    }
+    // fixed point, see rslib/math.rsc for the units.
+    void sin(INB_IMPL_PARAMETERS)   { mathCall("sin",   {MC_MATH_SCORE("x")},                     program, factory, parameters, err); }
+    void cos(INB_IMPL_PARAMETERS)   { mathCall("cos",   {MC_MATH_SCORE("x")},                     program, factory, parameters, err); }
+    void sqrt(INB_IMPL_PARAMETERS)  { mathCall("sqrt",  {MC_MATH_SCORE("x")},                     program, factory, parameters, err); }
+    void atan2(INB_IMPL_PARAMETERS) { mathCall("atan2", {MC_MATH_SCORE("y"), MC_MATH_SCORE("x")}, program, factory, parameters, err); }
+    void pow(INB_IMPL_PARAMETERS)   { mathCall("pow",   {MC_MATH_SCORE("x"), MC_MATH_SCORE("e")}, program, factory, parameters, err); }
+
+    // single data commands on a list variable, see rslib/lang.rsc.
+    void append(INB_IMPL_PARAMETERS)  { listModify(" append",  parameters.at(1), program, factory, parameters, err); }
+    void prepend(INB_IMPL_PARAMETERS) { listModify(" prepend", parameters.at(1), program, factory, parameters, err); }
+    void insert(INB_IMPL_PARAMETERS)
+    {
+        listModify(" insert " + std::get<0>(parameters.at(1)).val, parameters.at(2), program, factory, parameters, err);
+    }
+    void fill(INB_IMPL_PARAMETERS)    { listModify("[] set",   parameters.at(1), program, factory, parameters, err); }
+    void len(INB_IMPL_PARAMETERS)
+    {
+        rs_variable& list = *std::get<2>(parameters.at(0));
+        factory.returnResult(mc_command(false, MC_DATA_CMD_ID, MC_DATA(get storage, INS_L(factory.variablePath(list)))));
+    }
+    // copy(to, from), the whole list is replaced.
+    void copy(INB_IMPL_PARAMETERS)
+    {
+        rs_variable& to   = *std::get<2>(parameters.at(0));
+        rs_variable& from = *std::get<2>(parameters.at(1));
+        factory.copyStorage(factory.variablePath(to), factory.variablePath(from));
+    }
+
+    // keyed access to a map, see rslib/lang.rsc.
+    void map_set(INB_IMPL_PARAMETERS)    { mapCall("set",    program, factory, parameters, err); }
+    void map_get(INB_IMPL_PARAMETERS)    { mapCall("get",    program, factory, parameters, err); }
+    void map_has(INB_IMPL_PARAMETERS)    { mapCall("has",    program, factory, parameters, err); }
+    void map_remove(INB_IMPL_PARAMETERS) { mapCall("remove", program, factory, parameters, err); }
+    void map_size(INB_IMPL_PARAMETERS)
+    {
+        rs_variable& map = *std::get<2>(parameters.at(0));
+        factory.returnResult(mc_command(false, MC_DATA_CMD_ID, MC_DATA(get storage, INS(factory.variablePath(map))) "." RS_MAP_ENTRIES));
+    }
+
+    // slots of the heap, see rslib/lang.rsc. the functions are called with the id in args.heap.
+    void heap_new(INB_IMPL_PARAMETERS)
+    {
+        if (!factory.supports(mc_feature::MACROS))
+            IMPL_ERROR("impl::heap: the heap needs function macros, which the target version doesn't support.");
+        factory.returnResult(mc_command(false, MC_FUNCTION_CMD_ID, factory.useHeap("new")));
+        heapValue(parameters.at(0), program, factory, parameters, err);
+        factory.create_and_push(MC_FUNCTION_CMD_ID, factory.useHeap("set") + MC_FUNCTION_WITH(MC_HEAP_ARGUMENTS));
+    }
+    void heap_get(INB_IMPL_PARAMETERS)
+    {
+        if (!factory.supports(mc_feature::MACROS))
+            IMPL_ERROR("impl::heap: the heap needs function macros, which the target version doesn't support.");
+        factory.heapArgument(parameters.at(0));
+        factory.create_and_push(MC_FUNCTION_CMD_ID, factory.useHeap("get") + MC_FUNCTION_WITH(MC_HEAP_ARGUMENTS));
+        factory.create_and_push(MC_DATA_CMD_ID, MC_DATA(modify storage, RS_PROGRAM_RETURN_TYPE_REGISTER) PAD(set value) INS_L(STR(RS_ANY_KW_ID)));
+    }
+    void heap_set(INB_IMPL_PARAMETERS)
+    {
+        if (!factory.supports(mc_feature::MACROS))
+            IMPL_ERROR("impl::heap: the heap needs function macros, which the target version doesn't support.");
+        factory.heapArgument(parameters.at(0));
+        heapValue(parameters.at(1), program, factory, parameters, err);
+        factory.create_and_push(MC_FUNCTION_CMD_ID, factory.useHeap("set") + MC_FUNCTION_WITH(MC_HEAP_ARGUMENTS));
+    }
+    void heap_free(INB_IMPL_PARAMETERS)
+    {
+        if (!factory.supports(mc_feature::MACROS))
+            IMPL_ERROR("impl::heap: the heap needs function macros, which the target version doesn't support.");
+        factory.heapArgument(parameters.at(0));
+        factory.create_and_push(MC_FUNCTION_CMD_ID, factory.useHeap("free") + MC_FUNCTION_WITH(MC_HEAP_ARGUMENTS));
+    }
+
+    bool check(const std::string& name, const inb_intrinsic& intrinsic, std::vector<rbc_value>& arguments, std::string& err)
+    {
+        const size_t count = intrinsic.parameters.size();
+        if (intrinsic.variadic ? arguments.size() < count : arguments.size() != count)
+        {
+            err = "Wrong number of arguments for the inbuilt function '" + name + "'.";
+            return false;
+        }
+        for (size_t i = 0; i < arguments.size(); i++)
+        {
+            const inb_parameter& param = intrinsic.parameters.at(std::min(i, count - 1));
+            rbc_value& val = arguments.at(i);
+            const std::string which = "Argument " + std::to_string(i) + " of the inbuilt function '" + name + "'";
+
+            // selectors passed on to the function as macro arguments are put in the command as they are.
+            const bool macroSelector = val.index() == 2 && std::get<2>(val)->comp_info.macro
+                                    && std::get<2>(val)->type_info.type_id == RS_SELECTOR_KW_ID;
+            if (param.constant && val.index() != 0 && !(param.type == inb_type::SELECTOR && macroSelector))
+            {
+                err = which + " has to be known at compile time.";
+                return false;
+            }
+            bool matches = true;
+            switch (param.type)
+            {
+                case inb_type::ANY:
+                    break;
+                case inb_type::SELECTOR:
+                    matches = val.index() == 0 ? std::get<0>(val).val_type == token_type::SELECTOR_LITERAL : macroSelector;
+                    break;
+                case inb_type::STRING:
+                    matches = val.index() == 0 ? std::get<0>(val).val_type == token_type::STRING_LITERAL
+                                               : val.index() == 2 && std::get<2>(val)->type_info.type_id == RS_STRING_KW_ID;
+                    break;
+                case inb_type::LIST:
+                    matches = val.index() == 2 && std::get<2>(val)->type_info.isList();
+                    break;
+                case inb_type::MAP:
+                    matches = val.index() == 2 && std::get<2>(val)->type_info.type_id == RS_MAP_KW_ID && !std::get<2>(val)->type_info.array_count;
+                    break;
+                case inb_type::INT:
+                    if (val.index() == 0)
+                        matches = std::get<0>(val).val_type == token_type::INT_LITERAL;
+                    else if (val.index() == 1)
+                        matches = std::get<1>(val)->operable;
+                    else
+                        matches = val.index() == 2 && std::get<2>(val)->type_info.type_id == RS_INT_KW_ID;
+                    break;
+                case inb_type::REF:
+                    if (val.index() == 0)
+                        matches = std::get<0>(val).val_type == token_type::INT_LITERAL;
+                    else if (val.index() == 2)
+                    {
+                        // an untyped variable can hold what heap::new returned.
+                        const int32_t id = std::get<2>(val)->type_info.type_id;
+                        matches = id == RS_REF_KW_ID || id == RS_INT_KW_ID || id == -1;
+                    }
+                    break;
+            }
+            if (!matches)
+            {
+                err = which + " has the wrong type.";
+                return false;
+            }
+        }
+        return true;
     }
 }
\ No newline at end of file
@@ -3,6 +3,7 @@
 #include <vector>
 #include <variant>
 #include <memory>
+#include <string>
 
 struct rbc_constant;
 struct rbc_register;
@@ -17,14 +18,99 @@ typedef std::variant<rbc_constant, std::shared_ptr<rbc_register>, std::shared_pt
 struct rbc_program;
 #define INB_IMPL_PARAMETERS rbc_program& program, conversion::CommandFactory& factory, std::vector<rbc_value>& parameters, std::string& err 
 
+// what an intrinsic accepts as one of its arguments, checked before it's called.
+enum class inb_type
+{
+    ANY,
+    SELECTOR,
+    STRING,
+    INT,
+    LIST, // a list variable, written in place.
+    MAP,
+    REF // a handle to a heap slot, in a ref or an int.
+};
+struct inb_parameter
+{
+    inb_type type;
+    bool constant; // has to be a literal, selectors can also be parameters passed as macro arguments.
+};
+// an inbuilt (__cpp__) function, it gets the arguments of the call as they are in the byte code and
+// writes its commands in place of the call.
+struct inb_intrinsic
+{
+    std::vector<inb_parameter> parameters;
+    void(*impl)(INB_IMPL_PARAMETERS);
+    bool variadic = false; // the last parameter takes the rest of the arguments.
+};
+
 namespace inb_impls
 {
     void msg(INB_IMPL_PARAMETERS);
     void kill(INB_IMPL_PARAMETERS);
+    void get_player(INB_IMPL_PARAMETERS);
+    void enqueue(INB_IMPL_PARAMETERS);
+    void score_get(INB_IMPL_PARAMETERS);
+    void score_set(INB_IMPL_PARAMETERS);
+    void data_copy(INB_IMPL_PARAMETERS);
+    void store_result(INB_IMPL_PARAMETERS);
+    void store_success(INB_IMPL_PARAMETERS);
+    void random(INB_IMPL_PARAMETERS);
+    void schedule(INB_IMPL_PARAMETERS);
+    void sin(INB_IMPL_PARAMETERS);
+    void cos(INB_IMPL_PARAMETERS);
+    void sqrt(INB_IMPL_PARAMETERS);
+    void atan2(INB_IMPL_PARAMETERS);
+    void pow(INB_IMPL_PARAMETERS);
+    void append(INB_IMPL_PARAMETERS);
+    void prepend(INB_IMPL_PARAMETERS);
+    void insert(INB_IMPL_PARAMETERS);
+    void len(INB_IMPL_PARAMETERS);
+    void fill(INB_IMPL_PARAMETERS);
+    void copy(INB_IMPL_PARAMETERS);
+    void map_set(INB_IMPL_PARAMETERS);
+    void map_get(INB_IMPL_PARAMETERS);
+    void map_has(INB_IMPL_PARAMETERS);
+    void map_remove(INB_IMPL_PARAMETERS);
+    void map_size(INB_IMPL_PARAMETERS);
+    void heap_new(INB_IMPL_PARAMETERS);
+    void heap_get(INB_IMPL_PARAMETERS);
+    void heap_set(INB_IMPL_PARAMETERS);
+    void heap_free(INB_IMPL_PARAMETERS);
 
-    inline std::unordered_map<std::string, void(*)(INB_IMPL_PARAMETERS)> INB_IMPLS_MAP = 
+    inline std::unordered_map<std::string, inb_intrinsic> INB_IMPLS_MAP = 
     {
-        {"msg", msg},
-        {"kill", kill}
+        {"msg",           {{{inb_type::SELECTOR, true}, {inb_type::ANY, false}}, msg, true}},
+        {"kill",          {{{inb_type::SELECTOR, true}}, kill}},
+        {"get_player",    {{{inb_type::SELECTOR, true}}, get_player}},
+        {"enqueue",       {{{inb_type::STRING, true}, {inb_type::ANY, false}}, enqueue}},
+        {"score_get",     {{{inb_type::STRING, true}, {inb_type::STRING, true}}, score_get}},
+        {"score_set",     {{{inb_type::STRING, true}, {inb_type::STRING, true}, {inb_type::INT, false}}, score_set}},
+        {"data_copy",     {{{inb_type::STRING, true}, {inb_type::STRING, true}}, data_copy}},
+        {"store_result",  {{{inb_type::STRING, true}}, store_result}},
+        {"store_success", {{{inb_type::STRING, true}}, store_success}},
+        {"random",        {{{inb_type::INT, true}, {inb_type::INT, true}}, random}},
+        {"schedule",      {{{inb_type::STRING, true}, {inb_type::INT, true}}, schedule}},
+        {"math::sin",     {{{inb_type::INT, false}}, sin}},
+        {"math::cos",     {{{inb_type::INT, false}}, cos}},
+        {"math::sqrt",    {{{inb_type::INT, false}}, sqrt}},
+        {"math::atan2",   {{{inb_type::INT, false}, {inb_type::INT, false}}, atan2}},
+        {"math::pow",     {{{inb_type::INT, false}, {inb_type::INT, false}}, pow}},
+        {"lists::append", {{{inb_type::LIST, false}, {inb_type::ANY, false}}, append}},
+        {"lists::prepend",{{{inb_type::LIST, false}, {inb_type::ANY, false}}, prepend}},
+        {"lists::insert", {{{inb_type::LIST, false}, {inb_type::INT, true}, {inb_type::ANY, false}}, insert}},
+        {"lists::len",    {{{inb_type::LIST, false}}, len}},
+        {"lists::fill",   {{{inb_type::LIST, false}, {inb_type::ANY, false}}, fill}},
+        {"lists::copy",   {{{inb_type::LIST, false}, {inb_type::LIST, false}}, copy}},
+        {"maps::set",     {{{inb_type::MAP, false}, {inb_type::ANY, false}, {inb_type::ANY, false}}, map_set}},
+        {"maps::get",     {{{inb_type::MAP, false}, {inb_type::ANY, false}}, map_get}},
+        {"maps::has",     {{{inb_type::MAP, false}, {inb_type::ANY, false}}, map_has}},
+        {"maps::remove",  {{{inb_type::MAP, false}, {inb_type::ANY, false}}, map_remove}},
+        {"maps::size",    {{{inb_type::MAP, false}}, map_size}},
+        {"heap::new",     {{{inb_type::ANY, false}}, heap_new}},
+        {"heap::get",     {{{inb_type::REF, false}}, heap_get}},
+        {"heap::set",     {{{inb_type::REF, false}, {inb_type::ANY, false}}, heap_set}},
+        {"heap::free",    {{{inb_type::REF, false}}, heap_free}}
     };
+    // checks the arguments of a call against the parameters of the intrinsic, sets err if they don't match.
+    bool check(const std::string& name, const inb_intrinsic& intrinsic, std::vector<rbc_value>& arguments, std::string& err);
 };
\ No newline at end of file
@@ -65,6 +65,71 @@ std::shared_ptr<rs_object> parseInlineObject(rbc_program& program, token_list& t
     
 }
 
+std::shared_ptr<rs_variable> memberAccess(std::shared_ptr<rs_variable> var, const std::string& member)
+{
+    if (!var->fromObject)
+        return nullptr;
+
+    auto& projection = var->comp_info.projection;
+    if (var->comp_info.projected && var->fromObject->members.contains(member)
+        && std::find(projection.begin(), projection.end(), member) == projection.end())
+        projection.push_back(member);
+
+    auto cached = var->accessors.find(member);
+    if (cached != var->accessors.end())
+        return cached->second;
+
+    auto def = var->fromObject->members.find(member);
+    if (def == var->fromObject->members.end())
+        return nullptr;
+
+    rs_type_info& type = def->second.first.type_info;
+    auto accessor = std::make_shared<rs_variable>(var->from, type, type, var->scope, var->global);
+    accessor->name   = member;
+    accessor->parent = var.get();
+    accessor->comp_info.scoreboard = !var->comp_info.holder.empty();
+
+    var->accessors.insert({member, accessor});
+    return accessor;
+}
+
+void projectAll(rs_variable& var)
+{
+    var.comp_info.projection.clear();
+    for(auto& member : var.fromObject->members)
+        var.comp_info.projection.push_back(member.first);
+}
+
+// an element of a list, at a constant index (a path like any member) or at the value of a variable.
+std::shared_ptr<rs_variable> elementAccess(rbc_program& program, std::shared_ptr<rs_variable> var, const std::string& index)
+{
+    const std::string name = '[' + index + ']';
+    std::shared_ptr<rs_variable> position = nullptr;
+    if (index.empty())
+        return nullptr;
+    if (!std::all_of(index.begin(), index.end(), ::isdigit) && !(position = program.getVariable(index)))
+        return nullptr;
+
+    // the same name can be another variable in another function.
+    auto cached = var->accessors.find(name);
+    if (cached != var->accessors.end() && cached->second->comp_info.index == position)
+        return cached->second;
+
+    rs_type_info type = var->type_info;
+    // the elements of an untyped list can be anything.
+    if (type.array_count == 0)
+        type = rs_type_info{};
+    else
+        type.array_count--;
+    auto element = std::make_shared<rs_variable>(var->from, type, type, var->scope, var->global);
+    element->name   = name;
+    element->parent = var.get();
+    element->comp_info.index = position;
+
+    var->accessors[name] = element;
+    return element;
+}
+
 #pragma endregion objects
 #pragma region expressions
 
@@ -108,7 +173,7 @@ rs_expression::_ResultT rs_expression::rbc_evaluate(rbc_program& program, rs_err
     {
         token& value = std::get<token>(*node->left);
         std::shared_ptr<rs_variable> var;
-        if (var = program.getVariable(value))
+        if (value.type == token_type::WORD && (var = program.readVariable(value)))
             leftVal = std::make_shared<_ValueT>(var);
         else
             leftVal = std::make_shared<_ValueT>(rbc_constant(value.type, value.repr, &value.trace));
@@ -119,7 +184,13 @@ rs_expression::_ResultT rs_expression::rbc_evaluate(rbc_program& program, rs_err
 
     if (!rightIsToken)
     {
+        // the result of the left side has to survive the evaluation of the right side.
+        sharedt<rbc_register> held = leftVal->index() == 1 ? std::get<1>(*leftVal) : nullptr;
+        if (held)
+            held->vacant = false;
         auto rresult = rbc_evaluate(program, err, &std::get<_NodeT>(*node->right));
+        if (held)
+            held->vacant = true;
         if (err->trace.ec)
             return *leftVal;
         if(rresult.index() != 1)
@@ -138,13 +209,17 @@ rs_expression::_ResultT rs_expression::rbc_evaluate(rbc_program& program, rs_err
     {
         token& value = std::get<token>(*node->right);
         std::shared_ptr<rs_variable> var;
-        if (var = program.getVariable(value))
+        if (value.type == token_type::WORD && (var = program.readVariable(value)))
             rightVal = std::make_shared<_ValueT>(var);
         else
             rightVal = std::make_shared<_ValueT>(rbc_constant(value.type, value.repr, &value.trace));
     }
     sharedt<rbc_register> reg = nullptr;
     bool occupy = true;
+    // the result of the right side can't be the register the left side is read into.
+    sharedt<rbc_register> operand = rightVal->index() == 1 ? std::get<1>(*rightVal) : nullptr;
+    if (operand)
+        operand->vacant = false;
     if (leftVal->index() == 1)
     {
         reg = std::get<1>(*leftVal);
@@ -160,6 +235,8 @@ rs_expression::_ResultT rs_expression::rbc_evaluate(rbc_program& program, rs_err
         if (!reg)
             reg = program.makeRegister(operableRegister);
     }
+    if (operand)
+        operand->vacant = true;
     if (occupy)
         program (rbc_commands::registers::occupy(reg, *leftVal));
     program (rbc_commands::registers::operate(reg, *rightVal, static_cast<uint>(node->operation)));
@@ -234,7 +311,33 @@ bst_operation<token> make_bst(rbc_program &program, token_list &tlist, long &sta
             {
                 if (!program.getVariable(current.repr))
                     EXPR_ERROR(RS_SYNTAX_ERROR, "Unexpected token in expression.", current.trace);
-                if (!root.assignNext(current))
+                // member access (x.health), folded into one token so it evaluates like any other variable.
+                if (start + 2 < S && tlist.at(start + 1).type == token_type::SYMBOL && tlist.at(start + 1).info == '.')
+                {
+                    token access = current;
+                    access.repr += '.' + tlist.at(start + 2).repr;
+                    if (!program.getVariable(access.repr))
+                        EXPR_ERROR(RS_SYNTAX_ERROR, "Unknown object member '{}'.", tlist.at(start + 2).trace, tlist.at(start + 2).repr);
+                    start += 2;
+                    if (!root.assignNext(access))
+                        EXPR_ERROR(RS_SYNTAX_ERROR, "Missing operator.", current.trace);
+                }
+                // list element (xs[2], xs[i]), also folded into one token.
+                else if (start + 3 < S && tlist.at(start + 1).type == token_type::SQBRACKET_OPEN)
+                {
+                    token& index = tlist.at(start + 2);
+                    if (tlist.at(start + 3).type != token_type::SQBRACKET_CLOSED
+                        || (index.type != token_type::INT_LITERAL && index.type != token_type::WORD))
+                        EXPR_ERROR(RS_SYNTAX_ERROR, "A list index has to be a whole number or a variable.", index.trace);
+                    token access = current;
+                    access.repr += '[' + index.repr + ']';
+                    if (!program.getVariable(access.repr))
+                        EXPR_ERROR(RS_SYNTAX_ERROR, "'{}' isn't a list, or its index isn't known.", current.trace, current.repr);
+                    start += 3;
+                    if (!root.assignNext(access))
+                        EXPR_ERROR(RS_SYNTAX_ERROR, "Missing operator.", current.trace);
+                }
+                else if (!root.assignNext(current))
                     EXPR_ERROR(RS_SYNTAX_ERROR, "Missing operator.", current.trace);
             }
             else if (!root.assignNext(current))
@@ -247,9 +350,10 @@ bst_operation<token> make_bst(rbc_program &program, token_list &tlist, long &sta
         default:
             if ((current.info == ',' && (br || obj)) ||
                 (current.info == '}' && obj)         ||
-                (current.type == token_type::COMPARE_EQUAL || current.type == token_type::COMPARE_NOTEQUAL))
+                (current.type == token_type::COMPARE_EQUAL || current.type == token_type::COMPARE_NOTEQUAL) ||
+                (br && (current.type == token_type::KW_AND || current.type == token_type::KW_OR)))
             {
-                return root; // commas can end expressions in brackets
+                return root; // commas can end expressions in brackets, and/or end the terms of a condition
             }
             EXPR_ERROR(RS_SYNTAX_ERROR, "Unknown token in expression.", current.trace);
         }
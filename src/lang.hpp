@@ -11,6 +11,7 @@ struct rs_variable;
 struct rs_object;
 #include "bst.hpp"
 #include "token.hpp"
+#include "constants.hpp"
 
 struct rs_type_info
 {
@@ -19,6 +20,13 @@ struct rs_type_info
     bool optional = false;
     bool strict   = false;
     std::vector<rs_type_info> otherTypes; // others if specified
+    int32_t scale = 0; // of a fixed point float (float<1000>), 0 for the default one.
+    std::vector<rs_type_info> arguments; // key and value types of a map<K, V>.
+    // int[] or an untyped list.
+    inline bool isList() const
+    {
+        return array_count > 0 || (type_id == RS_LIST_KW_ID && otherTypes.empty());
+    }
     inline std::string tostr()
     {
 
@@ -49,7 +57,27 @@ struct rs_expression
 };
 struct rs_compilation_info
 {
+    // index in the variables list if stacked, otherwise of the flat slot.
     int varIndex = 0;
+    bool stacked = false;
+    // a top level variable of the global function, created (at its fixed index) by the load function.
+    bool loaded = false;
+    // cast from an entity by DOP. the members fetched by the cast are the ones read through the variable,
+    // collected as its uses are resolved (see memberAccess and rbc_program::readVariable).
+    bool projected = false;
+    std::vector<std::string> projection;
+    // fixed parameter slot of a non recursive function, written to directly by callers.
+    // scoreboard slots are formatted as `<holder> <objective>`.
+    std::string slot;
+    bool scoreboard = false;
+    // passed with `function ... with`, substituted as $(name) where it's used inside a command.
+    bool macro = false;
+    // a list element at a variable index, copied to and from its slot by a macro (see INDEX).
+    std::shared_ptr<rs_variable> index;
+    // the item of a for loop, the first element of the copy of the list it goes over.
+    std::shared_ptr<rs_variable> head;
+    // the entity (`@s`) a scoreboard object is bound to, its members are scores of that entity.
+    std::string holder;
 };
 class rs_variable
 {
@@ -62,6 +90,9 @@ public:
 
     std::shared_ptr<rs_expression> value = nullptr;
     std::shared_ptr<rs_object> fromObject = nullptr;
+    // set for member accessors (x.health), which live inside the storage of their parent.
+    rs_variable* parent = nullptr;
+    std::unordered_map<std::string, std::shared_ptr<rs_variable>> accessors;
 
     rs_compilation_info comp_info;
 
@@ -99,6 +130,8 @@ struct rs_object
     // negative for inline created objects
     int32_t typeID = -1;
     std::unordered_map<std::string, _MemberT> members;
+    // `object stats scoreboard { ... }`, every member is an objective instead of entity NBT.
+    bool scoreboard = false;
 
     inline std::string tostr()
     {
@@ -122,4 +155,8 @@ void prune_expr(rbc_program&, bst_operation<token>&, rs_error*);
 bst_operation<token> make_bst(rbc_program& program, token_list& tlist, long& start, rs_error* err, bool br = false, bool oneNode = false, bool obj = false);
 rs_expression expreval(rbc_program& program, token_list& tlist, long& start, rs_error* err,
                         bool br = false, bool lineEnd = true, bool obj = false, bool prune = true);
+std::shared_ptr<rs_variable> memberAccess(std::shared_ptr<rs_variable> var, const std::string& member);
+// a DOP cast used as a whole (passed, returned, gone over) fetches every member.
+void projectAll(rs_variable& var);
+std::shared_ptr<rs_variable> elementAccess(rbc_program& program, std::shared_ptr<rs_variable> var, const std::string& index);
 std::shared_ptr<rs_object> parseInlineObject(rbc_program& program, token_list& tlist, long& start, rs_error* err);
\ No newline at end of file
@@ -112,7 +112,28 @@ token_list tlex(const std::string &fName, std::string &content, rs_error *err =
         {
             bool isSelectorLiteral = ch == '@';
             long start = isSelectorLiteral ? _At + 1 : _At;
-            while ((ch = adv()) && (std::isalpha(ch) || ch == '_'));
+            while ((ch = adv()) && (std::isalnum(ch) || ch == '_'));
+            // the arguments are part of the literal, `@e[type=zombie,nbt={OnGround:1b}]`.
+            if (isSelectorLiteral && ch == '[')
+            {
+                int depth = 0;
+                char quote = 0;
+                do
+                {
+                    if (quote)
+                        quote = ch == quote ? 0 : quote;
+                    else if (ch == '"' || ch == '\'')
+                        quote = ch;
+                    else if (ch == '[' || ch == '{')
+                        depth++;
+                    else if (ch == ']' || ch == '}')
+                        depth--;
+                }
+                while (depth > 0 && (ch = adv()));
+                if (depth > 0)
+                    LEX_ERRORF(RS_SYNTAX_ERROR, "Unterminated selector arguments.", start);
+                adv();
+            }
 
             token t{content.substr(start, _At - start), isSelectorLiteral ? token_type::SELECTOR_LITERAL : token_type::WORD, 0, trace, start};
             
@@ -181,6 +202,7 @@ token_list tlex(const std::string &fName, std::string &content, rs_error *err =
             case '*':
             case '/':
             case '%':
+            case '^':
             {
                 customType = token_type::OPERATOR;
                 if (_At + 1 < S)
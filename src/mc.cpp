@@ -1,5 +1,7 @@
 #include "mc.hpp"
 #include "util.hpp"
+#include "constants.hpp"
+#include <cmath>
 mc_command::_This mc_command::addroot()
 {
     std::string name = "";
@@ -27,6 +29,15 @@ mc_command::_This mc_command::addroot()
     case MC_RETURN_CMD_ID:
         name = "return";
         break;
+    case MC_SCHEDULE_CMD_ID:
+        name = "schedule";
+        break;
+    case MC_TAG_CMD_ID:
+        name = "tag";
+        break;
+    case MC_RANDOM_CMD_ID:
+        name = "random";
+        break;
     default:
         WARN("Unknown command.");
         break;
@@ -51,7 +62,7 @@ mc_command::_This mc_command::ifcmpreg(comparison_operation_type t, int rid)
     bool eq = t == comparison_operation_type::EQ;
     std::string s = t == comparison_operation_type::EQ ? "if" : "unless";
     
-    body = s + " score " MC_COMPARE_REG_GET_RAW(INS_L(STR(rid))) + k + body;
+    body = s + " score " + MC_COMPARE_REG_GET_RAW(INS_L(STR(rid))) + k + body;
     return THIS;
 }
 mc_command::_This mc_command::ifcmp(const std::string &lhs, comparison_operation_type t, const std::string &rhs, bool negate)
@@ -170,19 +181,276 @@ mc_command::_This mc_command::storeResult(const std::string &where)
 {
     return store(true, where);
 }
-const std::filesystem::path makeDatapack(const std::filesystem::path &path)
+mc_register_layout registerLayout()
+{
+    if (RS_CONFIG.exists("registers") && RS_CONFIG.get<std::string>("registers") == "players")
+        return mc_register_layout::PLAYERS;
+    return mc_register_layout::OBJECTIVES;
+}
+std::string mc_register(const std::string &name)
+{
+    if (registerLayout() == mc_register_layout::PLAYERS)
+        return '#' + name + SEP RBC_REGISTER_PLAYER_OBJ;
+    return RBC_REGISTER_PLAYER SEP + name;
+}
+mc_storage_layout storageLayout()
+{
+    if (RS_CONFIG.exists("variables") && RS_CONFIG.get<std::string>("variables") == "flat")
+        return mc_storage_layout::FLAT;
+    return mc_storage_layout::LIST;
+}
+std::string mc_slot_name(uint index)
+{
+    std::string name;
+    for (index++; index > 0; index = (index - 1) / 26)
+        name.insert(name.begin(), static_cast<char>('a' + (index - 1) % 26));
+    return name;
+}
+std::string mc_escape_string(const std::string& value)
+{
+    static const std::string escapes = "\"\\/bfnrtu";
+    std::string escaped;
+    for (size_t i = 0; i < value.size(); i++)
+    {
+        const char c = value.at(i);
+        if (c == '"')
+            escaped += "\\\"";
+        else if (c != '\\')
+            escaped += c;
+        else if (i + 1 < value.size() && value.at(i + 1) == '\'')
+            escaped += value.at(++i);
+        else if (i + 1 < value.size() && escapes.find(value.at(i + 1)) != std::string::npos)
+            escaped += {c, value.at(++i)};
+        else
+            escaped += "\\\\";
+    }
+    return escaped;
+}
+std::string mc_text_json(const std::vector<mc_text>& parts)
+{
+    std::vector<std::string> components;
+    bool text = false;
+    for (const mc_text& part : parts)
+    {
+        if (part.literal && text)
+            components.back().insert(components.back().size() - 1, mc_escape_string(part.value));
+        else
+            components.push_back(part.literal ? '"' + mc_escape_string(part.value) + '"' : part.value);
+        text = part.literal;
+    }
+    // a lone string is a valid message on its own.
+    if (components.size() == 1 && text)
+        return components.front();
+    std::string json = "[";
+    for (size_t i = 0; i < components.size(); i++)
+        json += (i ? ", " : "") + components.at(i);
+    return json + ']';
+}
+static constexpr double mc_degrees = 180.0 / 3.14159265358979323846;
+std::vector<int> mc_math_table(const std::string& name)
+{
+    std::vector<int> table;
+    if (name == "sin")
+        for (int degree = 0; degree <= 360; degree++)
+            table.push_back(std::lround(std::sin(degree / mc_degrees) * RS_MATH_SCALE));
+    else if (name == "sqrt")
+        for (int x = 0; x <= 1024; x++)
+            table.push_back(std::lround(std::sqrt(x) * RS_MATH_SCALE));
+    else if (name == "atan")
+        // one more than needed, as the last entry is interpolated towards the next.
+        for (int x = 0; x <= 101; x++)
+            table.push_back(std::lround(std::atan(x / 100.0) * mc_degrees * RS_MATH_SCALE));
+    return table;
+}
+int mc_math_fold(const std::string& name, int a, int b)
+{
+    const double scale = RS_MATH_SCALE;
+    if (name == "sin")
+        return std::lround(std::sin(a / scale / mc_degrees) * scale);
+    if (name == "cos")
+        return std::lround(std::cos(a / scale / mc_degrees) * scale);
+    if (name == "sqrt")
+        return a < 0 ? 0 : std::lround(std::sqrt(a) * scale);
+    if (name == "atan2")
+        return std::lround(std::atan2(a, b) * mc_degrees * scale);
+    if (name == "pow")
+        return b < 0 ? 0 : std::lround(std::pow(a / scale, b) * scale);
+    return 0;
+}
+std::string mc_fixed_factor(int scale)
+{
+    char factor[32];
+    std::snprintf(factor, sizeof(factor), "%.10g", 1.0 / scale);
+    return factor;
+}
+// arguments of a selector, split at the commas that aren't inside a compound, list or string.
+static std::vector<std::string> selectorArguments(const std::string& selector)
+{
+    std::vector<std::string> arguments;
+    const size_t open = selector.find('[');
+    if (open == std::string::npos || selector.back() != ']')
+        return arguments;
+    int depth = 0;
+    char quote = 0;
+    size_t start = open + 1;
+    for (size_t i = start; i + 1 < selector.size(); i++)
+    {
+        const char c = selector.at(i);
+        if (quote)
+            quote = c == quote ? 0 : quote;
+        else if (c == '"' || c == '\'')
+            quote = c;
+        else if (c == '[' || c == '{')
+            depth++;
+        else if (c == ']' || c == '}')
+            depth--;
+        else if (c == ',' && depth == 0)
+        {
+            arguments.push_back(selector.substr(start, i - start));
+            start = i + 1;
+        }
+    }
+    if (start + 1 < selector.size())
+        arguments.push_back(selector.substr(start, selector.size() - 1 - start));
+    return arguments;
+}
+// type and position arguments limit which entities are looked at, the rest are tested on each of them in order.
+static uint selectorArgumentRank(const std::string& argument)
+{
+    static const std::vector<std::string> order =
+    {
+        "type", "distance", "x", "y", "z", "dx", "dy", "dz", "limit", "sort",
+        "tag", "team", "name", "gamemode", "level", "x_rotation", "y_rotation", "scores", "advancements", "predicate", "nbt"
+    };
+    const std::string key = argument.substr(0, argument.find('='));
+    for (size_t i = 0; i < order.size(); i++)
+        if (key == order.at(i))
+            return i;
+    // unknown arguments go before the ones reading the entity's data.
+    return order.size() - 3;
+}
+std::string mc_normalize_selector(const std::string& selector)
+{
+    std::vector<std::string> arguments = selectorArguments(selector);
+    if (arguments.empty())
+        return selector;
+    for (std::string& argument : arguments)
+    {
+        argument.erase(0, argument.find_first_not_of(' '));
+        argument.erase(argument.find_last_not_of(' ') + 1);
+    }
+    std::stable_sort(arguments.begin(), arguments.end(), [](const std::string& a, const std::string& b)
+    {
+        return selectorArgumentRank(a) < selectorArgumentRank(b);
+    });
+    std::string normalized = selector.substr(0, selector.find('[')) + '[';
+    for (size_t i = 0; i < arguments.size(); i++)
+        normalized += (i ? "," : "") + arguments.at(i);
+    return normalized + ']';
+}
+bool mc_cacheable_selector(const std::string& selector)
+{
+    // @r and @p pick again every time, @s is already known.
+    const char target = selector.front();
+    if (target != 'a' && target != 'e')
+        return false;
+    // entities moving, dying or changing their data change what these pick between two commands.
+    static const std::vector<std::string> changing =
+    {
+        "distance", "x", "y", "z", "dx", "dy", "dz", "limit", "sort", "x_rotation", "y_rotation",
+        "scores", "advancements", "predicate", "nbt"
+    };
+    const std::vector<std::string> arguments = selectorArguments(selector);
+    for (const std::string& argument : arguments)
+    {
+        const std::string key = argument.substr(0, argument.find('='));
+        if (std::find(changing.begin(), changing.end(), key) != changing.end())
+            return false;
+    }
+    return !arguments.empty();
+}
+std::string mc_tagged_selector(const std::string& selector, const std::string& tag)
+{
+    return std::string(1, selector.front()) + "[tag=" + tag + ']';
+}
+bool mc_target::supports(mc_feature feature) const
+{
+    switch (feature)
+    {
+    case mc_feature::STRING_SLICE:
+        return packFormat >= MC_STRING_SLICE_PACK_FORMAT;
+    case mc_feature::RETURN:
+        return packFormat >= MC_RETURN_PACK_FORMAT;
+    case mc_feature::MACROS:
+    case mc_feature::RETURN_RUN:
+    case mc_feature::RANDOM:
+    case mc_feature::OVERLAYS:
+        return packFormat >= MC_MACRO_PACK_FORMAT;
+    case mc_feature::EXECUTE_IF_FUNCTION:
+        return packFormat >= MC_EXECUTE_IF_FUNCTION_PACK_FORMAT;
+    }
+    return false;
+}
+mc_target mc_target::base()
+{
+    if (!RS_CONFIG.exists("versionid"))
+        throw std::runtime_error("'versionid' is not specified in redscript config.");
+    return mc_target{RS_CONFIG.get<int>("versionid")};
+}
+std::vector<mc_target> mc_target::overlays()
+{
+    std::vector<mc_target> targets;
+    if (!RS_CONFIG.exists("overlays"))
+        return targets;
+
+    // either a single pack format, or a comma separated list of them.
+    std::string list;
+    auto &value = RS_CONFIG.dict.at("overlays");
+    if (std::holds_alternative<int>(value))
+        list = std::to_string(std::get<int>(value));
+    else
+        list = std::get<std::string>(value);
+
+    const mc_target first = base();
+    std::stringstream stream(list);
+    std::string format;
+    while (std::getline(stream, format, ','))
+    {
+        mc_target target{std::stoi(format)};
+        // older versions don't read overlays, they are served by the base pack.
+        if (target.packFormat <= first.packFormat || !target.supports(mc_feature::OVERLAYS))
+        {
+            WARN("Ignoring overlay for pack format %d, it has to be newer than versionid and at least %d.", target.packFormat, MC_MACRO_PACK_FORMAT);
+            continue;
+        }
+        targets.push_back(target);
+    }
+    std::sort(targets.begin(), targets.end(), [](const mc_target &a, const mc_target &b) { return a.packFormat < b.packFormat; });
+    targets.erase(std::unique(targets.begin(), targets.end(), [](const mc_target &a, const mc_target &b) { return a.packFormat == b.packFormat; }), targets.end());
+    return targets;
+}
+const std::filesystem::path makeDatapack(const std::filesystem::path &path, const std::string &overlay)
 {
-    const std::filesystem::path funcDir = path / "data" / RS_STORAGE_NAME / "function";
+    const std::filesystem::path funcDir = (overlay.empty() ? path : path / overlay) / "data" / RS_STORAGE_NAME / "function";
     std::filesystem::create_directories(funcDir);
 
-    std::ofstream mcMetaPack(path / MC_MCMETA_FILE_NAME);
+    // pack.mcmeta is written with the base pack, overlays are listed in it up front.
+    if (!overlay.empty())
+        return funcDir;
 
-    if (!RS_CONFIG.exists("versionid"))
-        throw std::runtime_error("'versionid' is not specified in redscript config.");
+    std::ofstream mcMetaPack(path / MC_MCMETA_FILE_NAME);
 
-    const int version = RS_CONFIG.get<int>("versionid");
+    const int version = mc_target::base().packFormat;
 
-    mcMetaPack << MC_MCMETA_CONTENT(version);
+    // every overlay is used until the next one starts.
+    const std::vector<mc_target> targets = mc_target::overlays();
+    std::string entries;
+    for (size_t i = 0; i < targets.size(); i++)
+    {
+        const int max = i + 1 < targets.size() ? targets.at(i + 1).packFormat - 1 : std::numeric_limits<int>::max();
+        entries += (i ? ", " : "") + std::string(MC_MCMETA_OVERLAY(targets.at(i).packFormat, max, MC_OVERLAY_DIRECTORY(targets.at(i).packFormat)));
+    }
+    mcMetaPack << MC_MCMETA_CONTENT(version, targets.empty() ? std::string() : MC_MCMETA_OVERLAYS(entries));
 
     mcMetaPack.close();
 
@@ -197,7 +465,7 @@ std::shared_ptr<comparison_register> mc_program::getFreeComparisonRegister()
     }
     return nullptr;
 }
-void writemc(mc_program &program, std::string name, const std::string &path, std::string &err)
+void writemc(mc_program &program, std::string name, const std::string &path, std::string &err, const std::string &overlay)
 {
     if (!RS_CONFIG.exists("mcpath"))
     {
@@ -211,7 +479,11 @@ void writemc(mc_program &program, std::string name, const std::string &path, std
     {
         std::ofstream stream(path);
         for (auto &command : func.commands)
+        {
+            if (command.macro)
+                stream << '$';
             stream << command.body << '\n';
+        }
         stream.close();
         return true;
     };
@@ -228,7 +500,7 @@ void writemc(mc_program &program, std::string name, const std::string &path, std
             return;
         }
         mcpath /= MC_DATAPACK_FOLDER / (safeName.stem());
-        const std::filesystem::path funcPath = makeDatapack(mcpath);
+        const std::filesystem::path funcPath = makeDatapack(mcpath, overlay);
 
         std::filesystem::path to = funcPath / safeName;
         if (!writeFunction(program.globalFunction, to))
@@ -237,6 +509,28 @@ void writemc(mc_program &program, std::string name, const std::string &path, std
             err = std::format("Could not write function to '{}'.", to.string());
             return;
         }
+        if (!writeFunction(program.initFunction, funcPath / (program.initFunction.name + ".mcfunction")))
+            goto _error;
+        // tags are the same for every overlay, they only name the functions.
+        if (overlay.empty())
+        {
+            const std::filesystem::path tagPath = mcpath / "data" / "minecraft" / "tags" / "function";
+            std::filesystem::create_directories(tagPath);
+
+            auto writeTag = [&](const std::filesystem::path &file, const std::vector<std::string> &functions)
+            {
+                std::string values;
+                for (size_t i = 0; i < functions.size(); i++)
+                    values += (i ? ", \"" : "\"") + functions.at(i) + '"';
+                std::ofstream tag(tagPath / file);
+                tag << MC_FUNCTION_TAG(values);
+            };
+            writeTag(MC_LOAD_TAG_FILE, {RS_STORAGE_NAME ":" + program.initFunction.name});
+            if (!program.tickFunctions.empty())
+                writeTag(MC_TICK_TAG_FILE, program.tickFunctions);
+            else
+                std::filesystem::remove(tagPath / MC_TICK_TAG_FILE);
+        }
         for (auto &function : program.functions)
         {
 
@@ -3,6 +3,9 @@
 #include <vector>
 #include <filesystem>
 #include <stack>
+#include <limits>
+#include <set>
+#include <tuple>
 #include "error.hpp"
 #include "bst.hpp"
 #include "mchelpers.hpp"
@@ -15,12 +18,87 @@
 #define MC_TELLRAW_CMD_ID 4
 #define MC_KILL_CMD_ID 5
 #define MC_RETURN_CMD_ID 6
+#define MC_SCHEDULE_CMD_ID 7
+#define MC_TAG_CMD_ID 8
+#define MC_RANDOM_CMD_ID 9
 #define THIS *this;
 
 typedef unsigned int uint;
 struct rs_variable;
 struct rbc_function;
 
+// commands that only exist from some pack format on.
+enum class mc_feature
+{
+    STRING_SLICE,        // data modify ... string
+    RETURN,              // return <value>
+    MACROS,              // function macros
+    RETURN_RUN,          // return run
+    RANDOM,              // random value
+    OVERLAYS,            // overlay directories in pack.mcmeta
+    EXECUTE_IF_FUNCTION, // execute if function
+};
+// how registers are kept on the scoreboard, `registers` in rs.config.
+enum class mc_register_layout
+{
+    OBJECTIVES, // the _CPU player, on an objective per register (`_CPU r0`). the default.
+    PLAYERS,    // a fake player per register, all on one objective (`#r0 alu`).
+};
+mc_register_layout registerLayout();
+// the score holder and objective of a register, named `r0`, `cmp0`, `temp`, ...
+std::string mc_register(const std::string& name);
+
+// where variables are kept in storage, `variables` in rs.config.
+enum class mc_storage_layout
+{
+    LIST, // {value,scope,type} compounds appended to a list (`variables[3].value`). the default.
+    FLAT, // a key per variable in one compound (`v.d`), the type is only kept when it isn't known at compile time.
+};
+mc_storage_layout storageLayout();
+// shortest key of the nth variable with the flat layout: a, b, ..., z, aa, ab, ...
+std::string mc_slot_name(uint index);
+
+// a string literal (as written, with its escapes) made safe to place between double quotes in json or snbt:
+// quotes are escaped, \' becomes ' and a backslash that doesn't start an escape is doubled.
+std::string mc_escape_string(const std::string& value);
+// a piece of a tellraw message: text (the inside of a json string), or a text component read when it's sent.
+struct mc_text
+{
+    bool literal;
+    std::string value;
+};
+// the json of a message, adjacent text is joined into one string.
+std::string mc_text_json(const std::vector<mc_text>& parts);
+
+// fixed-point (RS_MATH_SCALE) tables of the math library: sin of 0..360 degrees, sqrt of 0..1024,
+// and atan of 0..1.01 in steps of 0.01 (in degrees).
+std::vector<int> mc_math_table(const std::string& name);
+// a math function worked out at compile time, for constant arguments (in the order of the call).
+int mc_math_fold(const std::string& name, int a, int b);
+// the factor a fixed point score is stored with as a double, 1000 is 0.001.
+std::string mc_fixed_factor(int scale);
+
+// selector literals are kept without their @ (`e[type=zombie,limit=1]`).
+// sorts the arguments so the ones narrowing the search come first, and the costly ones (nbt) last.
+std::string mc_normalize_selector(const std::string& selector);
+// repeated uses of a selector can be replaced by a tag applied once, if it picks the same entities every time.
+bool mc_cacheable_selector(const std::string& selector);
+// the selector of the entities tagged with tag by a cached selector.
+std::string mc_tagged_selector(const std::string& selector, const std::string& tag);
+
+// the pack format commands are generated for.
+struct mc_target
+{
+    int packFormat;
+
+    bool supports(mc_feature feature) const;
+
+    // `versionid`, written to pack.mcmeta.
+    static mc_target base();
+    // `overlays`, the pack formats compiled into their own overlay directory.
+    static std::vector<mc_target> overlays();
+};
+
 
 struct mc_command
 {
@@ -66,7 +144,28 @@ struct comparison_register
 };
 struct mc_program
 {
+    mc_target target;
+    // namespace of the functions.
+    std::string module;
+    // entries of the variables list in use, stacked variables are addressed from its end.
     uint varStackCount = 0;
+    // entries left on the list when the function being converted returns (its stacked parameters, popped by the caller).
+    uint frameBase = 0;
+    bool recursiveFrame = false;
+    // flat slots in use, and the first one no function has taken yet.
+    uint flatSlots = 0;
+    uint flatSlotsEnd = 0;
+    // the counters (and live ref variables) when each open scope was entered.
+    std::vector<std::tuple<uint, uint, size_t>> scopes;
+    uint parameterSlots = 0;
+    uint macroFunctions = 0;
+    uint outlinedFunctions = 0;
+    uint asyncFunctions = 0;
+    // frame of the async function being converted, its variables are kept there instead of the storage layout.
+    std::string asyncFrame;
+    bool scoreboardSlots = false;
+    // constants operated with, kept on the const objective.
+    std::set<int> constants;
     iterable_stack<std::pair<int, std::shared_ptr<comparison_register>>> blocks;
     std::vector<std::shared_ptr<comparison_register>> comparisonRegisters;
     std::vector<mc_function> functions;
@@ -74,9 +173,32 @@ struct mc_program
     // parameter name: parameter id
     std::vector<rs_variable*> stack;
     mc_function globalFunction;
+    // setup of the program, run by the load tag.
+    mc_function initFunction;
+    // paths of the functions in the tick tag.
+    std::vector<std::string> tickFunctions;
+    // tags replacing the selectors used more than once by the function being converted, as their selector and tag.
+    std::vector<std::pair<std::string, std::string>> cachedSelectors;
+    uint selectorTags = 0;
+    // functions of the math library used by the program, and the tables they read.
+    std::set<std::string> mathFunctions, mathTables;
+    // get and set functions used for list elements at a variable index, and the slots of those elements.
+    std::set<std::string> listFunctions;
+    // map operations used with a key known at runtime.
+    std::set<std::string> mapFunctions;
+    // heap functions used by the program, the scores given to ref variables, and the ref variables of the
+    // function being converted that are still in scope, their slots are freed when it ends.
+    std::set<std::string> heapFunctions;
+    uint heapHandles = 0;
+    std::vector<rs_variable*> heapRefs;
+    uint listElements = 0;
+    // functions queued with enqueue, their index is the job id.
+    std::vector<rbc_function*> jobs;
+    // compounds of the loaded global variables, and their flat slots (`"a": 3`) and types.
+    std::vector<std::string> loadedVariables, loadedSlots, loadedSlotTypes;
 
     std::shared_ptr<comparison_register> getFreeComparisonRegister();
     
 };
-const std::filesystem::path makeDatapack(const std::filesystem::path&);
-void writemc(mc_program&, std::string, const std::string&, std::string&);
\ No newline at end of file
+const std::filesystem::path makeDatapack(const std::filesystem::path&, const std::string& overlay = "");
+void writemc(mc_program&, std::string, const std::string&, std::string&, const std::string& overlay = "");
\ No newline at end of file
@@ -26,58 +26,162 @@
                                                  PADL(set) PAD(value) \
                                                  MC_VARIABLE_JSON_DEFAULT(scope, type) \
                                                  __VA_ARGS__
+// flat storage layout, see mc_slot_name.
+#define MC_VARIABLE_SLOT(id) RS_PROGRAM_SLOTS "." INS_L(mc_slot_name(id))
+#define MC_VARIABLE_SLOT_TYPE(id) RS_PROGRAM_SLOT_TYPES "." INS_L(mc_slot_name(id))
 #define MC_VARIABLE_SET_CONST(id, v) PADR(modify storage) RS_PROGRAM_DATA SEP ARR_AT(RS_PROGRAM_VARIABLES, STR(id)) PADR(.value set value) INS_L(v)
 #pragma endregion variables
 
 #pragma region registers
+// `<holder> <objective>` of a register, see mc_register. not a literal, concatenate with +.
+#define MC_REGISTER(name) mc_register(name)
 #define MC_COMPARE_REG(id) "cmp" INS_L(STR(id))
-#define MC_COMPARE_REG_FULL(id) RBC_REGISTER_PLAYER " cmp" INS_L(STR(id))
+#define MC_COMPARE_REG_FULL(id) MC_REGISTER(RBC_COMPARISON_RESULT_REGISTER INS_L(STR(id)))
 
 #define MC_OPERABLE_REG_RAW(id) "r" id
-#define MC_OPERABLE_REG(id) RBC_REGISTER_PLAYER SEP MC_OPERABLE_REG_RAW(id)
+#define MC_OPERABLE_REG(id) MC_REGISTER(MC_OPERABLE_REG_RAW(id))
 #define MC_CREATE_OPERABLE_REG(id, criteria) PADR(objectives add) MC_OPERABLE_REG_RAW(INS(STR(id))) SEP criteria SEP "\"" INS(STR(id)) "\""
-#define MC_COMPARE_REG_GET(id) PADR(players) PADR(get) RBC_REGISTER_PLAYER SEP RBC_COMPARISON_RESULT_REGISTER INS_L(STR(id))
-#define MC_COMPARE_REG_SET(id, val) PADR(players) PADR(set) RBC_REGISTER_PLAYER SEP RBC_COMPARISON_RESULT_REGISTER INS(STR(id)) SEP val
-#define MC_OPERABLE_REG_SET(id, v) PADR(players) PADR(set) MC_OPERABLE_REG(INS(STR(id))) SEP INS_L(v)
-#define MC_OPERABLE_REG_GET(id) PADR(players) PADR(get) MC_OPERABLE_REG(INS_L(STR(id)))
+// the objective of every register with the players layout.
+#define MC_CREATE_REGISTER_OBJ PADR(objectives add) RBC_REGISTER_PLAYER_OBJ " dummy \"" RBC_REGISTER_PLAYER_OBJ "\""
+#define MC_COMPARE_REG_GET(id) PADR(players) PADR(get) + MC_COMPARE_REG_FULL(id)
+#define MC_COMPARE_REG_SET(id, val) PADR(players) PADR(set) + MC_COMPARE_REG_FULL(id) + SEP val
+#define MC_OPERABLE_REG_SET(id, v) PADR(players) PADR(set) + MC_OPERABLE_REG(INS_L(STR(id))) + SEP INS_L(v)
+#define MC_OPERABLE_REG_GET(id) PADR(players) PADR(get) + MC_OPERABLE_REG(INS_L(STR(id)))
 #define MC_NOPERABLE_REG_GET(id) MC_DATA(get storage, ARR_AT(RS_PROGRAM_REGISTERS, STR(id)))
 #define MC_NOPERABLE_REG(id) RBC_REGISTER_PLAYER SEP ARR_AT(RS_PROGRAM_REGISTERS, STR(id))
 #pragma endregion registers
 
 #pragma region operable_math
-#define MC_REG_INCREMENT_CONST(id, x) PADR(players) PADR(add) MC_OPERABLE_REG(INS(STR(id))) SEP INS_L(x)
-#define MC_REG_DECREMENT_CONST(id, x) PADR(players) PADR(remove) MC_OPERABLE_REG(INS(STR(id))) SEP INS_L(x)
-#define MC_REG_OPERATE(lh_id, op_str, rh_id) PADR(players) PADR(operation) MC_OPERABLE_REG(INS(STR(lh_id))) SEP INS(op_str) SEP MC_OPERABLE_REG(INS_L(STR(rh_id)))
+#define MC_REG_INCREMENT_CONST(id, x) PADR(players) PADR(add) + MC_OPERABLE_REG(INS_L(STR(id))) + SEP INS_L(x)
+#define MC_REG_DECREMENT_CONST(id, x) PADR(players) PADR(remove) + MC_OPERABLE_REG(INS_L(STR(id))) + SEP INS_L(x)
+#define MC_REG_OPERATE(lh_id, op_str, rh_id) PADR(players) PADR(operation) + MC_OPERABLE_REG(INS_L(STR(lh_id))) + SEP INS(op_str) SEP + MC_OPERABLE_REG(INS_L(STR(rh_id)))
+// pooled constants are fake players of the const objective, set once by the program init (`#10 const`).
+#define MC_CONSTANT(v) "#" INS(v) SEP RBC_CONSTANT_OBJ
+#define MC_CONSTANT_SET(v) PADR(players set) MC_CONSTANT(v) SEP INS_L(v)
+#define MC_CREATE_CONSTANT_OBJ PADR(objectives add) RBC_CONSTANT_OBJ " dummy \"" RBC_CONSTANT_OBJ "\""
+#define MC_REG_OPERATE_CONST(lh_id, op_str, v) PADR(players) PADR(operation) + MC_OPERABLE_REG(INS_L(STR(lh_id))) + SEP INS(op_str) SEP MC_CONSTANT(v)
 #pragma endregion operable_math
 
+#pragma region parameters
+#define MC_PARAMETER_SLOT(id) RS_PROGRAM_ARGS ".p" INS_L(STR(id))
+#define MC_PARAMETER_SCORE_SLOT(id) "#p" INS(STR(id)) SEP RBC_PARAMETER_OBJ
+#define MC_CREATE_PARAMETER_OBJ PADR(objectives add) RBC_PARAMETER_OBJ " dummy \"" RBC_PARAMETER_OBJ "\""
+#define MC_SCORE_SET(where, v) PADR(players set) INS(where) SEP INS_L(v)
+#define MC_SCORE_COPY(dest, src) PADR(players operation) INS(dest) PAD(=) INS_L(src)
+#define MC_MACRO_ARGUMENTS(id) RS_PROGRAM_ARGS ".m" INS_L(STR(id))
+#define MC_MACRO(name) "$(" INS(name) ")"
+#define MC_SWITCH_ARGUMENTS RS_PROGRAM_ARGS ".case"
+#define MC_FUNCTION_WITH(path) PADL(with storage) SEP RS_PROGRAM_STORAGE SEP INS_L(path)
+#pragma endregion parameters
+
 #pragma region stack
+#define MC_STACK_TOP RS_PROGRAM_VARIABLES "[-1]"
+#define MC_DEBUG_COUNTER(name) "#" name SEP RBC_DEBUG_OBJ
+#define MC_CREATE_DEBUG_OBJ PADR(objectives add) RBC_DEBUG_OBJ " dummy \"" RBC_DEBUG_OBJ "\""
 #define MC_STACK_PUSH_CONST(x) MC_DATA(modify storage, RS_PROGRAM_STACK) PAD(append value) INS_L(x)
 #define MC_STACK_AT(id) ARR_AT(RS_PROGRAM_STACK, STR(id))
 #define MC_GET_STACK_VALUE(id) MC_DATA(get storage, MC_STACK_AT(id))
 
 #pragma endregion stack
 
-#pragma region tellraw
-#define MC_TELLRAW_CONST(selector, val) '@' INS(selector) SEP INS_L(val)
+#pragma region async
+// the frame of the running invocation, and the frames of the suspended ones in the order they resume.
+#define MC_ASYNC_FRAME(id) RS_PROGRAM_ASYNC ".f" INS_L(STR(id))
+#define MC_ASYNC_QUEUE(id) RS_PROGRAM_ASYNC ".q" INS_L(STR(id))
+#define MC_SCHEDULE_NEXT_TICK(path) PADR(function) INS(path) " 1t append"
+#pragma endregion async
+
+#pragma region scheduler
+// queued jobs are `{j:<id>,a:<argument>}`, the first one is the next to run.
+#define MC_JOB_JSON(id) "{j:" INS(STR(id)) "}"
+#define MC_JOB_JSON_VAL(id, arg) "{j:" INS(STR(id)) ",a:" INS(arg) "}"
+#define MC_NEXT_JOB RS_PROGRAM_JOBS "[0]"
+#define MC_LAST_JOB RS_PROGRAM_JOBS "[-1]"
+#define MC_SCHEDULER_COUNTER(name) "#" name SEP RBC_SCHEDULER_OBJ
+#define MC_CREATE_SCHEDULER_OBJ PADR(objectives add) RBC_SCHEDULER_OBJ " dummy \"" RBC_SCHEDULER_OBJ "\""
+#pragma endregion scheduler
+
+#pragma region math
+// fake players the math library works on, inputs are `#x` (and `#y` or `#e`).
+#define MC_MATH_SCORE(name) "#" name SEP RBC_MATH_OBJ
+#define MC_MATH_TABLE(name) RS_PROGRAM_MATH "." INS_L(name)
+#define MC_MATH_ARGUMENTS RS_PROGRAM_ARGS ".math"
+#define MC_CREATE_MATH_OBJ PADR(objectives add) RBC_MATH_OBJ " dummy \"" RBC_MATH_OBJ "\""
+#pragma endregion math
+
+#pragma region lists
+// the slot a list element at a variable index is copied to.
+#define MC_LIST_ELEMENT(id) RS_PROGRAM_ELEMENTS ".e" INS_L(STR(id))
+#define MC_LIST_ARGUMENTS RS_PROGRAM_ARGS ".list"
+#define MC_LIST_ARGUMENTS_JSON(list, element) "{list:\"" INS(list) "\",element:\"" INS(element) "\"}"
+#define MC_FOR_PAIR_JSON(name) "{" RS_FOR_PAIR_NAME ":\"" INS(name) "\"}"
+#pragma endregion lists
+
+#pragma region maps
+#define MC_MAP_EMPTY "{" RS_MAP_VALUES ":{}," RS_MAP_ENTRIES ":[]}"
+#define MC_MAP_VALUE(map, key) (map) + "." RS_MAP_VALUES ".\"" INS(key) "\""
+#define MC_MAP_ENTRY(map, key) (map) + "." RS_MAP_ENTRIES "[" MC_FOR_PAIR_JSON(key) "]"
+#define MC_MAP_ARGUMENTS RS_PROGRAM_ARGS ".map"
+#pragma endregion maps
+
+#pragma region heap
+// slots are keyed by their id, `heap."3"`. the last id given out is `#next`, handles of ref variables are `#h<n>`.
+#define MC_HEAP_SLOT(id) RS_PROGRAM_HEAP ".\"" INS(id) "\""
+#define MC_HEAP_SCORE(name) "#" INS(name) SEP RBC_HEAP_OBJ
+#define MC_HEAP_HANDLE(id) MC_HEAP_SCORE("h" + STR(id))
+#define MC_HEAP_ARGUMENTS RS_PROGRAM_ARGS ".heap"
+#define MC_CREATE_HEAP_OBJ PADR(objectives add) RBC_HEAP_OBJ " dummy \"" RBC_HEAP_OBJ "\""
+#pragma endregion heap
+
+#pragma region scoreboard objects
+// the objective of a member of a scoreboard object, `stats_points`.
+#define MC_FIELD_OBJECTIVE(type, member) (type) + "_" + (member)
+#define MC_CREATE_FIELD_OBJ(objective) PADR(objectives add) INS(objective) " dummy \"" INS(objective) "\""
+#pragma endregion scoreboard objects
 
-// DONT USE: not finished
-#define MC_TELLRAW_OPERABLE_REGISTER(selector, id) '@' INS(selector) SEP "[{\"score\":{" MC_OPERABLE_REG(id) ".value}, {\"storage\":\"" RS_PROGRAM_DATA "\"}"
-// for tellraw in particular a function needs to be made. Coming in next version.
-#define MC_TELLRAW_VARIABLE(selector, id) '@' INS(selector) SEP "[{\"nbt\":\"" ARR_AT(RS_PROGRAM_VARIABLES, STR(id))".value\", \"storage\":\"" RS_PROGRAM_STORAGE "\"}]"
+#pragma region tellraw
+#define MC_TELLRAW(selector, text) '@' INS(selector) SEP INS_L(text)
+// text components of a message, see mc_text.
+#define MC_TEXT_NBT(path) "{\"nbt\":\"" INS(path) "\", \"storage\":\"" RS_PROGRAM_STORAGE "\"}"
+// score holders are formatted as `<holder> <objective>`
+#define MC_TEXT_SCORE(holder) "{\"score\":{\"name\":\"" INS((holder).substr(0, (holder).find(' '))) "\", \"objective\":\"" INS((holder).substr((holder).find(' ') + 1)) "\"}}"
+#define MC_TEXT_SELECTOR(selector) "{\"selector\":\"@" INS(selector) "\"}"
 #pragma endregion tellraw
 
+#pragma region tags
+#define MC_FUNCTION_TAG(values) "{\"values\": [" INS(values) "]}"
+#define MC_LOAD_TAG_FILE "load.json"
+#define MC_TICK_TAG_FILE "tick.json"
+#pragma endregion tags
+
 #pragma region mcmeta
-#define MC_MCMETA_CONTENT(version) "{\"pack\": {\"pack_format\": " INS(STR(version)) ", \"description\": \"A program created by redscript.\"}}"
+#define MC_MCMETA_CONTENT(version, overlays) "{\"pack\": {\"pack_format\": " INS(STR(version)) ", \"description\": \"A program created by redscript.\"}" INS(overlays) "}"
+#define MC_MCMETA_OVERLAYS(entries) ", \"overlays\": {\"entries\": [" INS(entries) "]}"
+#define MC_MCMETA_OVERLAY(min, max, directory) "{\"formats\": {\"min_inclusive\": " INS(STR(min)) ", \"max_inclusive\": " INS(STR(max)) "}, \"directory\": \"" INS(directory) "\"}"
+#define MC_OVERLAY_DIRECTORY(format) "rs_" INS_L(STR(format))
 #pragma endregion mcmeta
 
 
 #pragma region inbuilt
+#define MC_EXECUTE_AS(selector) "as @" INS_L(selector)
+#define MC_AT_SELF " at @s"
+#define MC_TAG_ADD(selector, tag) '@' INS(selector) PAD(add) INS_L(tag)
+#define MC_TAG_REMOVE(selector, tag) '@' INS(selector) PAD(remove) INS_L(tag)
 #define MC_KILL(selector) '@' + selector
+#define MC_ENTITY(selector) "entity @" INS_L(selector)
+#define MC_DATA_COPY(target, source) PADR(modify) INS(target) PAD(set from) INS_L(source)
+#define MC_RANDOM_VALUE(min, max) PADR(value) INS(min) ".." INS_L(max)
+#define MC_SCHEDULE_DELAY(path, ticks) PADR(function) INS(path) SEP INS(ticks) "t"
 #pragma endregion inbuilt
 
 #pragma region conditionals
-#define MC_COMPARE_REG_GET_RAW(id) RBC_REGISTER_PLAYER SEP RBC_COMPARISON_RESULT_REGISTER id
+#define MC_COMPARE_REG_GET_RAW(id) MC_REGISTER(RBC_COMPARISON_RESULT_REGISTER id)
 #define MC_COMPARE_RESET(id) MC_COMPARE_REG_SET(id, "0")
+#define MC_COMPARE_REG_TEST(id) "score " + MC_COMPARE_REG_GET_RAW(INS_L(STR(id))) + " matches 1"
+// _internal always exists, for conditions known to fail.
+#define MC_FALSE_CONDITION "unless data storage " RS_PROGRAM_STORAGE SEP RS_PROGRAM_DATA
+#define MC_CONDITION_TERM(n) RS_PROGRAM_TERMS ".t" INS_L(STR(n))
+#define MC_CONDITION_TERM_FILTER(n, match) "{" RS_PROGRAM_TERMS ":{t" INS(STR(n)) ":" INS(match) "}}"
 #define MC_COMPARE_EQ(id, lhs, rhs) op PAD(data) lhs SEP rhs PAD(run scoreboard) MC_COMPARE_REG_SET(id, "1")
 #define MC_COMPARE_NEQ(id, lhs, rhs) op PAD(data) lhs SEP rhs PAD(run scoreboard) MC_COMPARE_REG_SET(id, "0")
 #define MC_CREATE_COMPARISON_REGISTER(id, criteria) PADR(objectives add) "cmp" INS(STR(id)) SEP criteria SEP "\"cmp" INS(STR(id)) "\""
@@ -86,9 +190,9 @@
 
 #pragma region temporary_storage
 #define MC_TEMP_STORAGE RS_PROGRAM_STORAGE SEP MC_TEMP_STORAGE_NAME
-#define MC_TEMP_SCOREBOARD_STORAGE RBC_REGISTER_PLAYER SEP MC_TEMP_STORAGE_NAME
+#define MC_TEMP_SCOREBOARD_STORAGE MC_REGISTER(MC_TEMP_STORAGE_NAME)
 #define MC_TEMP_STORAGE_SET_CONST(val) MC_DATA(modify storage, MC_TEMP_STORAGE_NAME) PAD(set value) INS_L(val)
-#define MC_TEMP_STORAGE_SCOREBOARD_SET_CONST(val) PADR(players set) MC_TEMP_SCOREBOARD_STORAGE SEP INS_L(val)
-#define MC_TEMP_STORAGE_SCOREBOARD_SET_RAW_CONST(val) PADR(players set) MC_TEMP_SCOREBOARD_STORAGE SEP val
+#define MC_TEMP_STORAGE_SCOREBOARD_SET_CONST(val) PADR(players set) + MC_TEMP_SCOREBOARD_STORAGE + SEP INS_L(val)
+#define MC_TEMP_STORAGE_SCOREBOARD_SET_RAW_CONST(val) PADR(players set) + MC_TEMP_SCOREBOARD_STORAGE + SEP val
 
 #pragma endregion temporary_storage
\ No newline at end of file
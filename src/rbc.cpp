@@ -5,6 +5,10 @@
 #include "mchelpers.hpp"
 
 #include <regex>
+#include <map>
+#include <cmath>
+#include <bit>
+#include <numeric>
 
 namespace rbc_commands
 {
@@ -38,6 +42,10 @@ namespace rbc_commands
         {
             return rbc_command(rbc_instruction::CREATE, rbc_value(var));
         }
+        rbc_command element(std::shared_ptr<rs_variable> var, bool store)
+        {
+            return rbc_command(rbc_instruction::INDEX, rbc_value(var), rbc_constant(token_type::INT_LITERAL, store ? "1" : "0"));
+        }
     }
 }
 
@@ -50,6 +58,9 @@ rbc_function_decorator parseDecorator(const std::string& name)
     if (name == "__single__")  return rbc_function_decorator::SINGLE;
     if (name == "__cpp__") return rbc_function_decorator::CPP;
     if (name == "__nocompile__") return rbc_function_decorator::NOCOMPILE;
+    if (name == "tick") return rbc_function_decorator::TICK;
+    if (name == "async") return rbc_function_decorator::ASYNC;
+    if (name == "variadic") return rbc_function_decorator::VARIADIC;
     return rbc_function_decorator::UNKNOWN;
 }
 
@@ -117,17 +128,9 @@ rs_variable* rbc_function::getParameterByName(const std::string& name)
 }
 rs_variable* rbc_function::getNthParameter(size_t p)
 {
-    size_t pc = 0;
-    for(auto& var : localVariables)
-    {
-        if (var.second.second)
-        {
-            if (pc == p)
-                return var.second.first.get();
-            pc++;
-        }
-    }
-    return nullptr;
+    if (p >= parameters.size())
+        return nullptr;
+    return localVariables.at(parameters.at(p)).first.get();
 }
 std::string rbc_function::toHumanStr()
 {
@@ -225,6 +228,27 @@ std::string rbc_command::toHumanStr()
         case rbc_instruction::POP:
             stream << "POP ";
             break;
+        case rbc_instruction::CAST:
+            stream << "CAST ";
+            break;
+        case rbc_instruction::YIELD:
+            stream << "YIELD";
+            break;
+        case rbc_instruction::AS:
+            stream << "AS ";
+            break;
+        case rbc_instruction::ENDAS:
+            stream << "ENDAS";
+            break;
+        case rbc_instruction::INDEX:
+            stream << "INDEX ";
+            break;
+        case rbc_instruction::FOR:
+            stream << "FOR ";
+            break;
+        case rbc_instruction::ENDFOR:
+            stream << "ENDFOR";
+            break;
     }
     int c = 0;
     for(auto& p : parameters)
@@ -250,8 +274,35 @@ std::string rbc_command::toHumanStr()
     }
     return stream.str();
 }
+std::shared_ptr<rs_variable> rbc_program::readVariable(const std::string& name)
+{
+    std::shared_ptr<rs_variable> var = getVariable(name);
+    if (var && var->comp_info.index)
+        operator()(rbc_commands::variables::element(var, false));
+    // used as a whole, every member of the cast is needed.
+    if (var && var->comp_info.projected && name.find('.') == std::string::npos)
+        projectAll(*var);
+    return var;
+}
 std::shared_ptr<rs_variable> rbc_program::getVariable(const std::string& name)
 {
+    // list elements, xs[2] or xs[i].
+    const size_t open = name.rfind('[');
+    if (open != std::string::npos && name.back() == ']')
+    {
+        std::shared_ptr<rs_variable> var = getVariable(name.substr(0, open));
+        if (!var || !var->type_info.isList())
+            return nullptr;
+        return elementAccess(*this, var, name.substr(open + 1, name.size() - open - 2));
+    }
+    const size_t access = name.find('.');
+    if (access != std::string::npos)
+    {
+        std::shared_ptr<rs_variable> var = getVariable(name.substr(0, access));
+        if (!var)
+            return nullptr;
+        return memberAccess(var, name.substr(access + 1));
+    }
     auto result = std::find_if(globalVariables.begin(), globalVariables.end(),
     [&](std::shared_ptr<rs_variable>& var)
         {return var->name == name;}
@@ -415,6 +466,36 @@ rbc_program torbc(token_list& tokens, std::string fName, std::string& content, r
                 COMP_ERROR_R(RS_SYNTAX_ERROR, "Type name unknown or not supported.", tinfo);
             typeID = custom->second->typeID;
         }
+        // floats can declare their fixed point scale, float<100> keeps two decimals.
+        int32_t scale = 0;
+        if (typeID == RS_FLOAT_KW_ID && (next = peek()) && next->type == token_type::SYMBOL && next->info == '<')
+        {
+            adv();
+            token* value = adv();
+            if (!value || value->type != token_type::INT_LITERAL || std::stoi(value->repr) <= 0)
+                COMP_ERROR_R(RS_SYNTAX_ERROR, "Expected a positive scale for the float.", tinfo);
+            scale = std::stoi(value->repr);
+            if (!match(token_type::SYMBOL, '>'))
+                COMP_ERROR_R(RS_SYNTAX_ERROR, "Expected '>' after the scale of the float.", tinfo);
+        }
+        // map<K, V>, the key is stringified so it's an int or a string. a plain map takes anything.
+        std::vector<rs_type_info> arguments;
+        if (typeID == RS_MAP_KW_ID && match(token_type::SYMBOL, '<'))
+        {
+            for(const char end : {',', '>'})
+            {
+                token* argument = adv();
+                if (!argument || (argument->type != token_type::TYPE_DEF && !program.objectTypes.contains(argument->repr)))
+                    COMP_ERROR_R(RS_SYNTAX_ERROR, "Expected the type of the map's keys and values.", tinfo);
+                rs_type_info type;
+                type.type_id = argument->type == token_type::TYPE_DEF ? argument->info : program.objectTypes.at(argument->repr)->typeID;
+                if (arguments.empty() && type.type_id != RS_INT_KW_ID && type.type_id != RS_STRING_KW_ID)
+                    COMP_ERROR_R(RS_SYNTAX_ERROR, "The keys of a map are ints or strings.", tinfo);
+                arguments.push_back(type);
+                if (!match(token_type::SYMBOL, end))
+                    COMP_ERROR_R(RS_SYNTAX_ERROR, "Expected '{}' in the map type.", tinfo, end);
+            }
+        }
         next = peek();
         bool optional = false;
         bool strict = false;
@@ -436,7 +517,7 @@ rbc_program torbc(token_list& tokens, std::string fName, std::string& content, r
         while (next = follows(token_type::SQBRACKET_OPEN))
         {
             arrayCount++;
-            if(!match(token_type::BRACKET_CLOSED))
+            if(!match(token_type::SQBRACKET_CLOSED))
                 COMP_ERROR_R(RS_SYNTAX_ERROR, "Unclosed type specified array.", tinfo);
         }
         if(tinfo.type_id == -1)
@@ -445,9 +526,11 @@ rbc_program torbc(token_list& tokens, std::string fName, std::string& content, r
             tinfo.strict = strict;
             tinfo.optional = optional;
             tinfo.array_count = arrayCount;
+            tinfo.scale = scale;
+            tinfo.arguments = arguments;
         }
         else
-            tinfo.otherTypes.push_back(rs_type_info{typeID, arrayCount, optional, strict});
+            tinfo.otherTypes.push_back(rs_type_info{typeID, arrayCount, optional, strict, {}, scale, arguments});
         if(!adv())
             COMP_ERROR_R(RS_SYNTAX_ERROR, "Missing semicolon.", tinfo);
 
@@ -459,6 +542,27 @@ rbc_program torbc(token_list& tokens, std::string fName, std::string& content, r
     // forward decl
     std::function<bool(std::string&, bool, std::shared_ptr<rs_module>)> callparse;
     // must be called at the index of the token after the variable name, ie myVar:int, at the colon.
+    // the constants of a list literal, `[1, 2, 3]` is written as it is. must be called at the index of '[', ends at ']'.
+    auto listparse = [&]() -> std::string
+    {
+        std::string elements;
+        while (adv() && current->type != token_type::SQBRACKET_CLOSED)
+        {
+            if (current->type != token_type::INT_LITERAL && current->type != token_type::FLOAT_LITERAL
+             && current->type != token_type::STRING_LITERAL)
+                COMP_ERROR_R(RS_SYNTAX_ERROR, "A list literal can only hold constants.", "");
+            rbc_constant element(current->type, current->repr);
+            element.quoteIfStr();
+            elements += (elements.empty() ? "" : ",") + element.val;
+            if (!adv() || (current->info != ',' && current->type != token_type::SQBRACKET_CLOSED))
+                COMP_ERROR_R(RS_SYNTAX_ERROR, "Expected ',' or ']' in the list literal.", "");
+            if (current->type == token_type::SQBRACKET_CLOSED)
+                break;
+        }
+        if (!current || current->type != token_type::SQBRACKET_CLOSED)
+            COMP_ERROR_R(RS_EOF_ERROR, "Unterminated list literal.", "");
+        return '[' + elements + ']';
+    };
     auto varparse = [&](token& name, bool needsTermination = true, bool parameter = false, bool obj = false, bool isConst = false) -> std::shared_ptr<rs_variable>
     {
         if (program.functions.find(name.repr) != program.functions.end()
@@ -484,6 +588,9 @@ rbc_program torbc(token_list& tokens, std::string fName, std::string& content, r
             switch(current->info)
             {
                 case ';':
+                    // declared without a value, it still needs its slot (maps start out empty).
+                    if (!obj && !parameter)
+                        program(rbc_commands::variables::create(variable));
                     break;
                 case '=':
                     goto _eval_expr;
@@ -510,13 +617,96 @@ rbc_program torbc(token_list& tokens, std::string fName, std::string& content, r
             if(!adv())
                 COMP_ERROR_R(RS_EOF_ERROR, "Expected expression, not EOF.", nullptr);
             token* next = nullptr;
+
+            // dynamic object parsing (DOP), see examples/docs/objects.md:
+            // x = (type) getPlayer(@p); | x = getPlayer(@p) as type; | x: type = getPlayer(@p);
+            std::shared_ptr<rs_object> castType = nullptr;
+            if (current->type == token_type::BRACKET_OPEN && (next = peek()) && next->type == token_type::WORD
+                && peek(2) && peek(2)->type == token_type::BRACKET_CLOSED)
+            {
+                auto type = program.objectTypes.find(next->repr);
+                if (type != program.objectTypes.end())
+                {
+                    castType = type->second;
+                    adv(3);
+                }
+            }
+            else if (variable->type_info.type_id >= (int32_t)rs_object::TYPE_CARET_START)
+            {
+                for(auto& type : program.objectTypes)
+                    if (type.second->typeID == variable->type_info.type_id)
+                        castType = type.second;
+            }
+            token* selector   = nullptr;
+            int    sourceSize = 0;
+            if (current->type == token_type::SELECTOR_LITERAL)
+                selector = current;
+            else if (current->repr == RS_ENTITY_SOURCE_FUNCTION && peek(3)
+                && peek()->type   == token_type::BRACKET_OPEN
+                && peek(2)->type  == token_type::SELECTOR_LITERAL
+                && peek(3)->type  == token_type::BRACKET_CLOSED)
+            {
+                selector   = peek(2);
+                sourceSize = 3;
+            }
+            if (selector && peek(sourceSize + 2) && peek(sourceSize + 1)->type == token_type::KW_AS)
+            {
+                if (castType)
+                    COMP_ERROR_R(RS_SYNTAX_ERROR, "Object is already being casted.", nullptr);
+                auto type = program.objectTypes.find(peek(sourceSize + 2)->repr);
+                if (type == program.objectTypes.end())
+                {
+                    adv(sourceSize + 2);
+                    COMP_ERROR_R(RS_SYNTAX_ERROR, "Unknown object type.", nullptr);
+                }
+                castType = type->second;
+                sourceSize += 2;
+            }
+            if (castType)
+            {
+                if (!selector)
+                    COMP_ERROR_R(RS_UNSUPPORTED_OPERATION_ERROR, "Only entities can be casted to an object type as of this version.", nullptr);
+                adv(sourceSize);
+                if (!adv() || current->type != token_type::LINE_END)
+                    COMP_ERROR_R(RS_SYNTAX_ERROR, "Missing semi-colon.", nullptr);
+
+                variable->fromObject = castType;
+                variable->real_type_info.type_id = castType->typeID;
+                // nothing is copied, the members are the entity's scores.
+                if (castType->scoreboard)
+                {
+                    if (!needsCreation)
+                        COMP_ERROR_R(RS_SYNTAX_ERROR, "A scoreboard object can't be bound to another entity.", nullptr);
+                    variable->comp_info.holder = '@' + selector->repr;
+                    break;
+                }
+                // the members read through it are added as its uses are parsed.
+                variable->comp_info.projected = true;
+
+                if (needsCreation)
+                    program(rbc_commands::variables::create(variable));
+                program(rbc_command(rbc_instruction::CAST, variable, rbc_constant(token_type::SELECTOR_LITERAL, selector->repr, &selector->trace)));
+                break;
+            }
+            // a function of a module, `x = math::sqrt(y);`
+            std::shared_ptr<rs_module> fromModule = nullptr;
+            if (current->type == token_type::WORD && (next = peek()) && next->type == token_type::MODULE_ACCESS
+                && peek(3) && peek(2)->type == token_type::WORD && peek(3)->type == token_type::BRACKET_OPEN)
+            {
+                auto found = program.modules.find(current->repr);
+                if (found == program.modules.end())
+                    COMP_ERROR_R(RS_SYNTAX_ERROR, "Unknown module name.", nullptr);
+                fromModule = found->second;
+                adv(2);
+            }
             if (current->type == token_type::WORD && (next = peek()) && next->type == token_type::BRACKET_OPEN)
             {
                 // its a function call, function calls are expensive and only allowed once in an expression,
                 // hence why we skip expreval here.
                 std::string& funcname = current->repr;
-                auto f = program.functions.find(funcname);
-                if (f != program.functions.end())
+                auto& functions = fromModule ? fromModule->functions : program.functions;
+                auto f = functions.find(funcname);
+                if (f != functions.end())
                 {
                     auto& decorators = f->second->decorators;
                     if(std::find(decorators.begin(), decorators.end(), rbc_function_decorator::NORETURN) != decorators.end())
@@ -524,7 +714,7 @@ rbc_program torbc(token_list& tokens, std::string fName, std::string& content, r
                 }
                 adv();
 
-                if (!callparse(funcname, false, nullptr))
+                if (!callparse(funcname, false, fromModule))
                     return nullptr;
                 if (!adv() || current->type != token_type::LINE_END)
                     COMP_ERROR_R(RS_SYNTAX_ERROR, "Missing semi-colon. This error can arise if you are calling a function within an expression. Function calls are not allowed in arithmetic expressions.", nullptr);
@@ -534,6 +724,27 @@ rbc_program torbc(token_list& tokens, std::string fName, std::string& content, r
                 program(rbc_commands::variables::storeReturn(variable));
                 break;
             }
+            // a list of constants, `xs = [1, 2, 3];`, written to the storage as it is.
+            if (current->type == token_type::SQBRACKET_OPEN)
+            {
+                token* open = current;
+                const std::string elements = listparse();
+                if (err->trace.ec)
+                    return nullptr;
+                if (!adv() || current->type != token_type::LINE_END)
+                    COMP_ERROR_R(RS_SYNTAX_ERROR, "Missing semi-colon.", nullptr);
+                if (variable->type_info.type_id == -1)
+                    variable->type_info.type_id = RS_LIST_KW_ID;
+                else if (!variable->type_info.isList())
+                    COMP_ERROR_R(RS_SYNTAX_ERROR, "Variable isn't a list.", nullptr);
+
+                rbc_value val = rbc_constant(token_type::LIST_LITERAL, elements, &open->trace);
+                if (needsCreation)
+                    program(rbc_commands::variables::create(variable, val));
+                else
+                    program(rbc_commands::variables::set(variable, val));
+                break;
+            }
             rs_expression expr = expreval(program, tokens, _At, err);
             if(err->trace.ec)
                 return nullptr;
@@ -543,7 +754,7 @@ rbc_program torbc(token_list& tokens, std::string fName, std::string& content, r
             {
                 auto& value = std::get<token>(*expr.operation.left);
 
-                rbc_value val = value.type == token_type::WORD ? program.getVariable(value.repr) : rbc_value(rbc_constant(value.type, value.repr, &value.trace));
+                rbc_value val = value.type == token_type::WORD ? program.readVariable(value.repr) : rbc_value(rbc_constant(value.type, value.repr, &value.trace));
                 // no need to evaluate.
                 if (needsCreation)
                     program(rbc_commands::variables::create(variable, val));
@@ -563,6 +774,40 @@ rbc_program torbc(token_list& tokens, std::string fName, std::string& content, r
             }
             break;
         }      
+        // `x += y` is `x = x + (y)`, for every arithmetic operator.
+        case '+':
+        case '-':
+        case '*':
+        case '/':
+        case '%':
+        {
+            // the lexer reads '+=' and the like as one token.
+            if (current->type != token_type::VAR_OPERATOR)
+                COMP_ERROR_R(RS_SYNTAX_ERROR, "Expected '{1}=' after the variable.", nullptr, std::string(1, current->info));
+            if (!exists)
+                COMP_ERROR_R(RS_SYNTAX_ERROR, "Unknown variable '{1}'.", nullptr, name.repr);
+            bst_operation<token> operation;
+            operation.assignNext(name);
+            operation.setOperation(current->info);
+            adv();
+            rs_expression rhs = expreval(program, tokens, _At, err);
+            if (err->trace.ec)
+                return nullptr;
+            if (rhs.nonOperationalResult)
+                COMP_ERROR_R(RS_SYNTAX_ERROR, "Only numbers can be operated on.", nullptr);
+            if (rhs.operation.isSingular())
+                operation.assignNext(std::get<token>(*rhs.operation.left));
+            else
+                operation.assignNext(rhs.operation);
+
+            rs_expression expr;
+            expr.operation = operation;
+            auto result = expr.rbc_evaluate(program, err);
+            if (err->trace.ec)
+                return nullptr;
+            program(rbc_commands::variables::set(variable, result));
+            break;
+        }
         case '.': // access variable's contents (only if real_type_info says it's an object)
             break;
         case ';':
@@ -590,7 +835,11 @@ rbc_program torbc(token_list& tokens, std::string fName, std::string& content, r
             if(!program.currentFunction)
                 program.globalVariables.push_back(variable);
             else
+            {
                 program.currentFunction->localVariables.insert({variable->name, {variable, parameter}});
+                if (parameter)
+                    program.currentFunction->parameters.push_back(variable->name);
+            }
         }
         return variable;
     };
@@ -599,15 +848,12 @@ rbc_program torbc(token_list& tokens, std::string fName, std::string& content, r
     // must be called at index of open br, example: f() => ( <-
     callparse = [&](std::string& name, bool needsTermination = true, std::shared_ptr<rs_module> fromModule = nullptr) -> bool
     {
-        std::unordered_map<std::string, std::shared_ptr<rbc_function>>::iterator func;
-        if (fromModule)
-            func = fromModule->functions.find(name);
-        else
-            func = program.functions.find(name);
+        auto& functions = fromModule ? fromModule->functions : program.functions;
+        auto func = functions.find(name);
         std::shared_ptr<rbc_function> function = nullptr;
         bool inbuilt = false;
         bool internal = false;
-        if (func == program.functions.end())
+        if (func == functions.end())
         {
             if (!program.currentFunction)
             {
@@ -637,6 +883,10 @@ rbc_program torbc(token_list& tokens, std::string fName, std::string& content, r
             inbuilt = true;
         if (std::find(decorators.begin(), decorators.end(), rbc_function_decorator::CPP) != decorators.end())
             internal = true;
+        const bool variadic = std::find(decorators.begin(), decorators.end(), rbc_function_decorator::VARIADIC) != decorators.end();
+        // an inbuilt function is given its arguments all at once by the call, so the registers holding them can't be
+        // reused by the arguments after them.
+        std::vector<sharedt<rbc_register>> held;
         adv();
         if (current->type != token_type::BRACKET_CLOSED)
         {
@@ -653,6 +903,9 @@ rbc_program torbc(token_list& tokens, std::string fName, std::string& content, r
                     return false;
 
                 rs_variable* param = function->getNthParameter(pc);
+                // the extra arguments of a variadic function are passed to its last parameter.
+                if (!param && variadic)
+                    param = function->getNthParameter(function->parameters.size() - 1);
                 if (!param)
                     COMP_ERROR_R(RS_SYNTAX_ERROR, "No matching function call with pc of {}", false, pc);
 
@@ -664,6 +917,11 @@ rbc_program torbc(token_list& tokens, std::string fName, std::string& content, r
                     c.parameters.push_back(std::make_shared<rbc_value>(fromModule));
                 }
                 program(c);
+                if (internal && result.index() == 1)
+                {
+                    std::get<1>(result)->vacant = false;
+                    held.push_back(std::get<1>(result));
+                }
                 pc ++;
                 if (current->info == ',')
                     adv();
@@ -687,7 +945,7 @@ rbc_program torbc(token_list& tokens, std::string fName, std::string& content, r
             if (var.second.second)
                 actualpc ++;
         }
-        if (actualpc != pc)
+        if (variadic ? pc < actualpc : actualpc != pc)
             COMP_ERROR_R(RS_SYNTAX_ERROR, "No matching function call with pc of {}", false, pc);
         rbc_command c(rbc_instruction::CALL);
 
@@ -703,6 +961,8 @@ rbc_program torbc(token_list& tokens, std::string fName, std::string& content, r
             c.parameters.push_back(std::make_shared<rbc_value>(rbc_value(fromModule)));
         
         program(c);
+        for(auto& reg : held)
+            reg->free();
         if (!internal)
             for(int i = 0; i < pc; i++)
                 program(rbc_command(rbc_instruction::POP));
@@ -744,9 +1004,9 @@ rbc_program torbc(token_list& tokens, std::string fName, std::string& content, r
         if (current->type != token_type::CBRACKET_OPEN)
             COMP_ERROR_R(RS_SYNTAX_ERROR, "Expected object body.", nullptr);
         rs_object obj{name};
-        rs_object_member_decorator decorator = rs_object_member_decorator::OPTIONAL;
         while(adv() && current->type != token_type::CBRACKET_CLOSED)
         {
+            rs_object_member_decorator decorator = rs_object_member_decorator::OPTIONAL;
             // dont append to global scope
             token* name;
             token_type& t = current->type;
@@ -785,38 +1045,108 @@ rbc_program torbc(token_list& tokens, std::string fName, std::string& content, r
             COMP_ERROR_R(RS_EOF_ERROR, "Unterminated object body.", nullptr);
         return std::make_shared<rs_object>(obj);
     };
-    // must be called at the index of the opening bracket 
+    // `for (item in xs) { ... }` goes over a copy of the list, the item being its first element, which is removed
+    // after each run. `for (x: pair in obj) { ... }` runs the block once per member of the object's type.
+    // must be called at the index of the for keyword.
     auto forparse = [&]() -> bool
     {
+        if (!adv() || current->type != token_type::BRACKET_OPEN)
+            COMP_ERROR_R(RS_SYNTAX_ERROR, "Expected '('.", false);
+        if (!adv() || current->type != token_type::WORD)
+            COMP_ERROR_R(RS_SYNTAX_ERROR, "Expected the name of the item.", false);
+        token& name = *current;
+        rs_type_info type;
         if (!adv())
+            COMP_ERROR_R(RS_EOF_ERROR, "Expected keyword 'in', not EOF.", false);
+        if (current->info == ':')
         {
-            _eoferr:
-                COMP_ERROR_R(RS_EOF_ERROR, "Expected expression, not EOF.", false);
+            type = typeparse();
+            if (err->trace.ec)
+                return false;
         }
-        bool _const = false;
-        if (current->type == token_type::KW_CONST)
+        if (current->type != token_type::KW_IN)
+            COMP_ERROR_R(RS_SYNTAX_ERROR, "Expected keyword 'in'.", false);
+        if (!adv())
+            COMP_ERROR_R(RS_EOF_ERROR, "Expected a list or an object, not EOF.", false);
+
+        token& from = *current;
+        std::shared_ptr<rs_variable> source = nullptr;
+        std::string literal;
+        if (current->type == token_type::SQBRACKET_OPEN)
         {
-            _const = true;
-            adv();
+            literal = listparse();
+            if (err->trace.ec)
+                return false;
         }
-        else if (current->type != token_type::WORD)
-            COMP_ERROR_R(RS_SYNTAX_ERROR, "Unexepcted token.", false);
-
-        _At++; // raw advance, maintain current as name of variable.
-        std::shared_ptr<rs_variable> var = varparse(*current, false, true, false, _const);
-
-        if (!var)
-            return false;
-
-        if (follows(token_type::KW_IN))
+        else if (current->type != token_type::WORD || !(source = program.getVariable(current->repr)))
+            COMP_ERROR_R(RS_SYNTAX_ERROR, "Expected a list or an object to go over.", false);
+        if (source && source->comp_info.projected)
+            projectAll(*source);
+        if (!adv() || current->type != token_type::BRACKET_CLOSED)
+            COMP_ERROR_R(RS_SYNTAX_ERROR, "Expected ')'.", false);
+        if (!adv() || current->type != token_type::CBRACKET_OPEN)
+            COMP_ERROR_R(RS_SYNTAX_ERROR, "Expected '{'.", false);
+
+        rs_type_info list;
+        list.type_id = RS_LIST_KW_ID;
+        // a map is gone over by the list of its entries.
+        if (source && source->type_info.type_id == RS_MAP_KW_ID && !source->type_info.array_count)
         {
-            // can be function call to range() or an object literal / variable, list literal / variable.
-            auto expr = expreval(program, tokens, _At, err, true, false);
-            // todo parse function | variable, don't accept math, so dont use expreval.
-            COMP_ERROR_R(RS_UNSUPPORTED_OPERATION_ERROR, "Not implemented as of this version.", false);
-        } else COMP_ERROR_R(RS_SYNTAX_ERROR, "Expected keyword 'in'.", false);
-        
-        return false;
+            auto entries = std::make_shared<rs_variable>(source->from, list, list, source->scope, source->global);
+            entries->name   = RS_MAP_ENTRIES;
+            entries->parent = source.get();
+            source->accessors.insert({entries->name, entries});
+            source = source->accessors.at(entries->name);
+            if (type.type_id == -1)
+                for(auto& [_, pair] : program.objectTypes)
+                    if (pair->name == RS_FOR_PAIR_TYPE)
+                        type.type_id = pair->typeID;
+        }
+        const bool object = source && !source->type_info.isList();
+        if (object && (!source->fromObject || source->fromObject->name.empty()))
+            COMP_ERROR_R(RS_SYNTAX_ERROR, "Only lists and objects of a declared type can be gone over.", false);
+
+        program.scopeStack.push(rbc_scope_type::FOR);
+        program(rbc_command(rbc_instruction::INC));
+        program.currentScope ++;
+
+        auto item = std::make_shared<rs_variable>(name, program.currentScope, !program.currentFunction);
+        item->type_info = type;
+        for(auto& [_, pair] : program.objectTypes)
+            if (pair->typeID == type.type_id)
+                item->fromObject = pair;
+        if (object)
+        {
+            // the name of the member and its value, see pair in rslib/lang.rsc.
+            for(auto& [_, pair] : program.objectTypes)
+                if (type.type_id == -1 && pair->name == RS_FOR_PAIR_TYPE)
+                    item->fromObject = pair;
+            if (!item->fromObject)
+                COMP_ERROR_R(RS_SYNTAX_ERROR, "The item of an object is a " RS_FOR_PAIR_TYPE " (use lang;).", false);
+            item->type_info.type_id = item->fromObject->typeID;
+            program(rbc_commands::variables::create(item));
+            program(rbc_command(rbc_instruction::FOR, source, item, source->fromObject));
+        }
+        else
+        {
+            auto copy = std::make_shared<rs_variable>(from, program.currentScope, !program.currentFunction);
+            copy->type_info = source ? source->type_info : list;
+            program(rbc_commands::variables::create(copy, source ? rbc_value(source) : rbc_value(rbc_constant(token_type::LIST_LITERAL, literal, &from.trace))));
+            // the elements of an untyped list can be anything.
+            if (type.type_id == -1 && copy->type_info.array_count)
+            {
+                item->type_info = copy->type_info;
+                item->type_info.array_count--;
+            }
+            item->comp_info.head = copy;
+            program(rbc_command(rbc_instruction::FOR, copy, item));
+        }
+        // a loop after another one with the same item name gets its own.
+        if (program.currentFunction)
+            program.currentFunction->localVariables[item->name] = {item, false};
+        else
+            program.globalVariables.insert(program.globalVariables.begin(), item);
+        return true;
     };
 #pragma endregion objects
     do
@@ -827,7 +1157,19 @@ rbc_program torbc(token_list& tokens, std::string fName, std::string& content, r
         {
         _parseword:
             token& word = *current;
-            if (follows(token_type::SYMBOL))
+            // a member of an object, `p.points = 3;` or `p.points += 1;`.
+            if (peek() && peek()->type == token_type::SYMBOL && peek()->info == '.'
+                && peek(2) && peek(2)->type == token_type::WORD && program.getVariable(word.repr))
+            {
+                token member = word;
+                member.repr += '.' + peek(2)->repr;
+                if (!program.getVariable(member.repr))
+                    COMP_ERROR(RS_SYNTAX_ERROR, "Unknown object member '{1}'.", peek(2)->repr);
+                adv(3);
+                if (!varparse(member))
+                    return program;
+            }
+            else if (follows(token_type::SYMBOL) || follows(token_type::VAR_OPERATOR))
             {
                 if(program.currentModule && !program.currentFunction)
                     COMP_ERROR(RS_SYNTAX_ERROR, "Modules can only contain functions.");
@@ -839,6 +1181,26 @@ rbc_program torbc(token_list& tokens, std::string fName, std::string& content, r
                     before && before->type == token_type::KW_CONST))
                     return program;
             }
+            // an element of a list, `xs[i] = 4;`.
+            else if (peek() && peek()->type == token_type::SQBRACKET_OPEN)
+            {
+                token* index = peek(2);
+                if (!index || (index->type != token_type::INT_LITERAL && index->type != token_type::WORD)
+                    || !peek(3) || peek(3)->type != token_type::SQBRACKET_CLOSED)
+                    COMP_ERROR(RS_SYNTAX_ERROR, "A list index has to be a whole number or a variable.");
+                token element = word;
+                element.repr += '[' + index->repr + ']';
+                auto var = program.getVariable(element.repr);
+                if (!var)
+                    COMP_ERROR(RS_SYNTAX_ERROR, "Variable isn't a list, or its index isn't known.");
+                adv(4);
+                if (current->info != '=')
+                    COMP_ERROR(RS_SYNTAX_ERROR, "Expected '=' after the list element.");
+                if (!varparse(element))
+                    return program;
+                if (var->comp_info.index)
+                    program(rbc_commands::variables::element(var, true));
+            }
             else if (follows(token_type::BRACKET_OPEN))
             {
                 if(!callparse(word.repr, true, nullptr))
@@ -995,9 +1357,19 @@ rbc_program torbc(token_list& tokens, std::string fName, std::string& content, r
                 auto& decorators = program.currentFunction->decorators;
                 if (std::find(decorators.begin(), decorators.end(), decorator) != decorators.end())
                     COMP_ERROR(RS_SYNTAX_ERROR, "Duplicate function decorator: '{}'.", dName);
+                // the caller has moved on by the time an async function finishes.
+                if (decorator == rbc_function_decorator::ASYNC && program.currentFunction->returnType->type_id != -1)
+                    COMP_ERROR(RS_SYNTAX_ERROR, "Async functions must return void.");
 
                 decorators.push_back(decorator);
             }
+            // only inbuilt functions get all of their arguments at once.
+            {
+                auto& decorators = program.currentFunction->decorators;
+                if (std::find(decorators.begin(), decorators.end(), rbc_function_decorator::VARIADIC) != decorators.end()
+                &&  std::find(decorators.begin(), decorators.end(), rbc_function_decorator::CPP) == decorators.end())
+                    COMP_ERROR(RS_SYNTAX_ERROR, "Only inbuilt (__cpp__) functions can be variadic.");
+            }
             if(_At >= S)
                 COMP_ERROR(RS_SYNTAX_ERROR, "Missing function definition or semi-colon.");
             switch(current->type)
@@ -1094,6 +1466,17 @@ rbc_program torbc(token_list& tokens, std::string fName, std::string& content, r
                     program(rbc_command(rbc_instruction::DEC));
                     break;
                 }
+                case rbc_scope_type::AS:
+                {
+                    program(rbc_command(rbc_instruction::ENDAS));
+                    break;
+                }
+                case rbc_scope_type::FOR:
+                {
+                    program(rbc_command(rbc_instruction::ENDFOR));
+                    program(rbc_command(rbc_instruction::DEC));
+                    break;
+                }
             }
             if (!program.currentModule)
                 program.currentScope--;
@@ -1143,15 +1526,73 @@ rbc_program torbc(token_list& tokens, std::string fName, std::string& content, r
             }
             break;
         }
+        case token_type::KW_FOR:
+        {
+            if (!forparse())
+                return program;
+            break;
+        }
+        case token_type::KW_AS:
+        case token_type::KW_AT:
+        {
+            // `as (@e[type=pig]) { ... }`, at also runs the block at the entity's position.
+            const bool at = current->type == token_type::KW_AT;
+            if (!adv() || current->type != token_type::BRACKET_OPEN)
+                COMP_ERROR(RS_SYNTAX_ERROR, "Expected '('.");
+            if (!adv() || current->type != token_type::SELECTOR_LITERAL)
+                COMP_ERROR(RS_SYNTAX_ERROR, "Expected selector literal.");
+            token& selector = *current;
+            if (!adv() || current->type != token_type::BRACKET_CLOSED)
+                COMP_ERROR(RS_SYNTAX_ERROR, "Expected ')'.");
+            if (!adv() || current->type != token_type::CBRACKET_OPEN)
+                COMP_ERROR(RS_SYNTAX_ERROR, "Expected '{'.");
+
+            program.scopeStack.push(rbc_scope_type::AS);
+            program(rbc_command(rbc_instruction::AS, rbc_constant(token_type::SELECTOR_LITERAL, selector.repr, &selector.trace),
+                                                     rbc_constant(token_type::INT_LITERAL, at ? "1" : "0")));
+            program.currentScope ++;
+            break;
+        }
+        case token_type::KW_AWAIT:
+        {
+            // the only thing that can be awaited is the next tick, `await tick;` is the same as `yield;`.
+            if (!adv() || current->type != token_type::WORD || current->repr != "tick")
+                COMP_ERROR(RS_SYNTAX_ERROR, "Expected 'tick' after await.");
+            [[fallthrough]];
+        }
+        case token_type::KW_YIELD:
+        {
+            if (!program.currentFunction || std::find(program.currentFunction->decorators.begin(), program.currentFunction->decorators.end(),
+                                                       rbc_function_decorator::ASYNC) == program.currentFunction->decorators.end())
+                COMP_ERROR(RS_SYNTAX_ERROR, "Only async functions can yield.");
+            // the function is split at its yields, which can't be inside a block.
+            if (program.scopeStack.empty() || program.scopeStack.top() != rbc_scope_type::FUNCTION)
+                COMP_ERROR(RS_SYNTAX_ERROR, "Async functions can only yield outside of blocks.");
+            if (!adv() || current->type != token_type::LINE_END)
+                COMP_ERROR(RS_SYNTAX_ERROR, "Missing semi-colon.");
+            program(rbc_command(rbc_instruction::YIELD));
+            break;
+        }
         case token_type::KW_IF:
         {
         _parseif:
+        {
             if (!adv() || current->type != token_type::BRACKET_OPEN)
                 COMP_ERROR(RS_SYNTAX_ERROR, "Unexpected token.");
-                
+
+            // terms joined by `and`/`or` constants, each term is `[not] value [==|!= value]`.
+            std::vector<rbc_value> condition;
+            // registers of earlier terms have to survive the evaluation of later ones.
+            std::vector<sharedt<rbc_register>> held;
         _parseifagain: // for and and or keywords
             if(!adv())
                 COMP_ERROR(RS_SYNTAX_ERROR, "Expected expression, not EOF.");
+            while (current->type == token_type::KW_NOT)
+            {
+                condition.push_back(rbc_constant(token_type::KW_NOT, current->repr, &current->trace));
+                if(!adv())
+                    COMP_ERROR(RS_SYNTAX_ERROR, "Expected expression, not EOF.");
+            }
             // br = true as if we hit the closing bracket of the if statement we should return.
             rs_expression left = expreval(program, tokens, _At, err, true, false, false);
             if(err->trace.ec)
@@ -1159,59 +1600,69 @@ rbc_program torbc(token_list& tokens, std::string fName, std::string& content, r
             rbc_value lVal = left.rbc_evaluate(program, err);
             if(err->trace.ec)
                 return program;
-            
-            resync();
-
-            if (current->type == token_type::BRACKET_CLOSED)
+            if (lVal.index() == 1)
             {
-                program(rbc_command(_flag_parsingelif ? rbc_instruction::ELIF : rbc_instruction::IF, lVal));
-            end_if_parse:
-                if (!adv())
-                    COMP_ERROR(RS_EOF_ERROR, "Unexpected EOF.");
-
-                if (current->type != token_type::CBRACKET_OPEN)
-                    COMP_ERROR(RS_SYNTAX_ERROR, "Unexpected token.");
-                
-                program.currentScope++;
-                program.scopeStack.push(_flag_parsingelif ? rbc_scope_type::ELIF : rbc_scope_type::IF);
-                break;
+                std::get<1>(lVal)->vacant = false;
+                held.push_back(std::get<1>(lVal));
             }
+            condition.push_back(lVal);
 
-            token& op         = *current;
-            token_type compop = op.type;   
-            if(compop != token_type::COMPARE_EQUAL && compop != token_type::COMPARE_NOTEQUAL)
-                COMP_ERROR(RS_SYNTAX_ERROR, "Unexpected token.");
-
-            if(!adv())
-                COMP_ERROR(RS_SYNTAX_ERROR, "Expected expression, not EOF.");
-            // br = true as if we hit the closing bracket of the if statement we should return.
-            // prune = false as expreval has mismatching problems after when encountering this ).
-            // horrible code having 4 boolean flags, maybe make struct.
-            rs_expression right = expreval(program, tokens, _At, err, true, false, false);
-            if (err->trace.ec)
-                return program;
             resync();
-            rbc_value rVal = right.rbc_evaluate(program, err);
-            if(err->trace.ec)
-                return program;
-            token_type t = current->type;
 
-            switch(t)
+            token_type compop = current->type;
+            if (compop == token_type::COMPARE_EQUAL || compop == token_type::COMPARE_NOTEQUAL)
+            {
+                token& op = *current;
+                if(!adv())
+                    COMP_ERROR(RS_SYNTAX_ERROR, "Expected expression, not EOF.");
+                // br = true as if we hit the closing bracket of the if statement we should return.
+                // prune = false as expreval has mismatching problems after when encountering this ).
+                // horrible code having 4 boolean flags, maybe make struct.
+                rs_expression right = expreval(program, tokens, _At, err, true, false, false);
+                if (err->trace.ec)
+                    return program;
+                resync();
+                rbc_value rVal = right.rbc_evaluate(program, err);
+                if(err->trace.ec)
+                    return program;
+                if (rVal.index() == 1)
+                {
+                    std::get<1>(rVal)->vacant = false;
+                    held.push_back(std::get<1>(rVal));
+                }
+                condition.push_back(rbc_constant(compop, op.repr, &op.trace));
+                condition.push_back(rVal);
+            }
+
+            switch(current->type)
             {
                 case token_type::KW_AND:
                 case token_type::KW_OR:
-                    if(!adv())
-                        COMP_ERROR(RS_SYNTAX_ERROR, "Expected expression, not EOF.");
+                    condition.push_back(rbc_constant(current->type, current->repr, &current->trace));
                     goto _parseifagain;
                 case token_type::BRACKET_CLOSED:
                     break;
                 default:
                     COMP_ERROR(RS_SYNTAX_ERROR, "Unexpected token.");
-
             }
-            program(rbc_command(_flag_parsingelif ? rbc_instruction::ELIF : rbc_instruction::IF, lVal, rbc_constant(compop, op.repr, &op.trace), rVal));
+            rbc_command instruction(_flag_parsingelif ? rbc_instruction::ELIF : rbc_instruction::IF);
+            for(rbc_value& value : condition)
+                instruction.parameters.push_back(std::make_shared<rbc_value>(value));
+            program(instruction);
+            for(auto& reg : held)
+                reg->free();
+
+            if (!adv())
+                COMP_ERROR(RS_EOF_ERROR, "Unexpected EOF.");
+
+            if (current->type != token_type::CBRACKET_OPEN)
+                COMP_ERROR(RS_SYNTAX_ERROR, "Unexpected token.");
             
-            goto end_if_parse;
+            program.currentScope++;
+            program.scopeStack.push(_flag_parsingelif ? rbc_scope_type::ELIF : rbc_scope_type::IF);
+            _flag_parsingelif = false;
+            break;
+        }
         }
         case token_type::KW_ELIF:
         {
@@ -1253,10 +1704,23 @@ rbc_program torbc(token_list& tokens, std::string fName, std::string& content, r
                         COMP_ERROR(RS_SYNTAX_ERROR, "Object with name already exists.");
                     
                     adv();
+                    const bool scoreboard = current->type == token_type::WORD && current->repr == RS_SCOREBOARD_OBJECT;
+                    if (scoreboard)
+                        adv();
 
                     auto obj = objparse(name);
                     if (err->trace.ec)
                         return program;
+                    // each member is an objective, the scores of an entity being its fields.
+                    obj->scoreboard = scoreboard;
+                    if (scoreboard)
+                        for(auto& [_, member] : obj->members)
+                        {
+                            const rs_type_info& type = member.first.type_info;
+                            if ((type.type_id != RS_INT_KW_ID && type.type_id != RS_BOOL_KW_ID && type.type_id != RS_FLOAT_KW_ID)
+                              || type.array_count || !type.otherTypes.empty())
+                                COMP_ERROR(RS_SYNTAX_ERROR, "The members of a scoreboard object are ints, bools or floats.");
+                        }
                     obj->typeID = rs_object::TYPE_CARET_START + program.objectTypes.size();
                     program.objectTypes.insert({name, obj});
                     break;
@@ -1277,11 +1741,12 @@ void preprocess(token_list& tokens, std::string fName, std::string& content, rs_
                 std::shared_ptr<std::vector<std::filesystem::path>> visited)
 {
     long         _At = 0;
-    const size_t S   = tokens.size();
+    size_t       S   = tokens.size();
     std::filesystem::path rootPath = std::filesystem::absolute(fName);
 
+    // the file being compiled counts as included, importing it again does nothing.
     if(!visited)
-        visited = std::make_shared<std::vector<std::filesystem::path>>();
+        visited = std::make_shared<std::vector<std::filesystem::path>>(1, rootPath);
 
     do
     {
@@ -1297,9 +1762,6 @@ void preprocess(token_list& tokens, std::string fName, std::string& content, rs_
                 token& path = tokens.at(++_At);
                 std::string file = (std::regex_replace(path.repr, std::regex("\\."), "/") + ".rsc");
                 std::filesystem::path filePath = rootPath.parent_path() / file;
-                if (visited && std::find(visited->begin(), visited->end(), filePath) != visited->end())
-                    COMP_ERROR_R(RS_ALREADY_INCLUDED_ERROR, "This file has already been included.",);
-                visited->push_back(filePath);
                 std::string fileContent = readFile(filePath);
 
                 if (fileContent.empty())
@@ -1322,6 +1784,10 @@ void preprocess(token_list& tokens, std::string fName, std::string& content, rs_
 
                 if (_At + 1 >= S || tokens.at(++_At).type != token_type::LINE_END)
                     COMP_ERROR_R(RS_SYNTAX_ERROR, "Missing semicolon.",);
+                // files are included once, importing one that is already included (like math, by lang) does nothing.
+                if (std::find(visited->begin(), visited->end(), filePath) != visited->end())
+                    break;
+                visited->push_back(filePath);
                 std::string filePathStr = filePath.string();
                 token_list fileTokens = tlex(filePathStr, fileContent, err);
 
@@ -1341,167 +1807,1001 @@ void preprocess(token_list& tokens, std::string fName, std::string& content, rs_
                 tokens.insert(tokens.begin(), fileTokens.begin(), fileTokens.end());
 
                 content = fileContent + '\n' + content;
+                // imports after this one are further along.
                 _At += fileTokens.size();
+                S   += fileTokens.size();
 
                 break;
             }
+            // everything else is left to the compiler.
+            default:
+                break;
         }
     } while(++_At < S);
 }
 #define RS_ASSERTC(C, m) if (!(C)) {err=m;return {};}
 #define RS_ASSERT_SIZE(C) RS_ASSERTC(C, "Invalid byte code parameter count. This error is a bug, flag it on github.")
 #define RS_ASSERT_SUCCESS if (!err.empty()) {return mcprogram;}
-mc_program tomc(rbc_program& program, const std::string& moduleName, std::string& err)
+// copies instructions along with their parameters, conversion quotes constants in place.
+static std::vector<rbc_command> copyInstructions(const std::vector<rbc_command>& instructions)
+{
+    std::vector<rbc_command> copy;
+    copy.reserve(instructions.size());
+    for(const rbc_command& instruction : instructions)
+    {
+        rbc_command& c = copy.emplace_back(instruction.type);
+        for(auto& param : instruction.parameters)
+            c.parameters.push_back(std::make_shared<rbc_value>(*param));
+    }
+    return copy;
+}
+mc_program tomc(rbc_program& program, const std::string& moduleName, std::string& err, const mc_target& target)
 {
     mc_program mcprogram;
+    mcprogram.target = target;
+    mcprogram.module = moduleName;
     conversion::CommandFactory factory(mcprogram, program);
-    
-    auto parseFunction = [&](std::vector<rbc_command>& instructions) -> mccmdlist
+
+    // finds the function called by a CALL instruction.
+    auto resolveCall = [&](rbc_command& instruction) -> std::shared_ptr<rbc_function>
     {
-        for(size_t i = 0; i < instructions.size(); i++)
-        {
-            auto& instruction = instructions.at(i);
-            const size_t size = instruction.parameters.size();
+        rbc_value& p0 = *instruction.parameters.at(0);
+        if (p0.index() != 0)
+            return std::static_pointer_cast<rbc_function>(std::get<std::shared_ptr<void>>(p0));
 
+        const std::string& name = std::get<rbc_constant>(p0).val;
+        if (instruction.parameters.size() > 1)
+        {
+            rs_module* fromModule = (rs_module*) std::get<std::shared_ptr<void>>(*instruction.parameters.at(1)).get();
+            if (!fromModule)
+                return nullptr;
+            auto f = fromModule->functions.find(name);
+            return f == fromModule->functions.end() ? nullptr : f->second;
+        }
+        auto f = program.functions.find(name);
+        return f == program.functions.end() ? nullptr : f->second;
+    };
+    // finds the function a PUSH instruction passes a parameter to.
+    auto resolvePush = [&](rbc_command& instruction) -> std::shared_ptr<rbc_function>
+    {
+        const std::string& name = std::get<rbc_constant>(*instruction.parameters.at(0)).val;
+        if (instruction.parameters.size() == 4)
+        {
+            rs_module* fromModule = (rs_module*) std::get<std::shared_ptr<void>>(*instruction.parameters.at(3)).get();
+            if (!fromModule)
+                return nullptr;
+            auto f = fromModule->functions.find(name);
+            return f == fromModule->functions.end() ? nullptr : f->second;
+        }
+        auto f = program.functions.find(name);
+        return f == program.functions.end() ? nullptr : f->second;
+    };
+    // the selector literal an instruction reads, given to an inbuilt function, cast from or run as.
+    auto selectorOf = [&](rbc_command& instruction) -> rbc_constant*
+    {
+        rbc_value* value = nullptr;
+        if (instruction.type == rbc_instruction::CAST && instruction.parameters.size() > 1)
+            value = instruction.parameters.at(1).get();
+        else if (instruction.type == rbc_instruction::AS)
+            value = instruction.parameters.at(0).get();
+        else if (instruction.type == rbc_instruction::PUSH && instruction.parameters.size() > 2)
+        {
+            std::shared_ptr<rbc_function> callee = resolvePush(instruction);
+            if (callee && std::find(callee->decorators.begin(), callee->decorators.end(), rbc_function_decorator::CPP) != callee->decorators.end())
+                value = instruction.parameters.at(2).get();
+        }
+        if (!value || value->index() != 0 || std::get<rbc_constant>(*value).val_type != token_type::SELECTOR_LITERAL)
+            return nullptr;
+        return &std::get<rbc_constant>(*value);
+    };
+    // a call that can kill or change entities, any function of the program can.
+    auto changesEntities = [&](rbc_command& instruction) -> bool
+    {
+        if (instruction.type != rbc_instruction::CALL)
+            return false;
+        std::shared_ptr<rbc_function> f = resolveCall(instruction);
+        if (!f || std::find(f->decorators.begin(), f->decorators.end(), rbc_function_decorator::CPP) == f->decorators.end())
+            return true;
+        static const std::vector<std::string> changing = RS_ENTITY_CHANGING_INTRINSICS;
+        return std::find(changing.begin(), changing.end(), f->name) != changing.end();
+    };
+    // the first use of each cached selector, the entities are tagged right before it (see cacheSelectors).
+    std::unordered_map<const rbc_constant*, std::pair<std::string, std::string>> selectorTagsAt;
+    // normalizes the selectors passed to inbuilt functions and cast from. a selector used more than once in a row,
+    // with nothing changing entities in between, is tagged before the first use and replaced by the tag (removed when
+    // the function ends). only uses outside of blocks count, as the tag has to be there for all of them.
+    auto cacheSelectors = [&](std::vector<rbc_command>& instructions, const bool cache)
+    {
+        // the uses of each selector, split where entities could have changed.
+        std::map<std::string, std::vector<std::vector<rbc_constant*>>> runs;
+        uint changes = 0;
+        std::map<std::string, uint> lastChange;
+        int depth = 0;
+        for(auto& instruction : instructions)
+        {
+            if (changesEntities(instruction))
+                changes++;
+            rbc_constant* selector = selectorOf(instruction);
+            if (selector)
+                selector->val = mc_normalize_selector(selector->val);
+            if (selector && depth == 0)
+            {
+                auto& uses = runs[selector->val];
+                auto last = lastChange.find(selector->val);
+                if (uses.empty() || last->second != changes)
+                    uses.emplace_back();
+                uses.back().push_back(selector);
+                lastChange[selector->val] = changes;
+            }
             switch(instruction.type)
             {
-                case rbc_instruction::CREATE:
-                {
-                    RS_ASSERT_SIZE(size > 0);
-                    rs_variable& var = *std::get<sharedt<rs_variable>>(*instruction.parameters.at(0));
-                    if (instruction.parameters.size() == 1)
-                        factory.createVariable(var);
-                    else
-                    {
-                        rbc_value& val = *instruction.parameters.at(1);
-                        factory.createVariable(var, val);
-                    }
-                    // RS_ASSERT_SUCCESS;
+                case rbc_instruction::IF:
+                case rbc_instruction::NIF:
+                case rbc_instruction::INC:
+                case rbc_instruction::AS:
+                case rbc_instruction::FOR:
+                    depth++;
                     break;
-                }
-                case rbc_instruction::SAVE:
-                {
-                    RS_ASSERT_SIZE(size == 2);
-                    rbc_value& reg = *instruction.parameters.at(0);
-                    switch(reg.index())
-                    {
-                        // register
-                        case 1:
-                        {
-                            rbc_register& regist = *std::get<sharedt<rbc_register>>(reg);
-                            regist.vacant = false;
-                            factory.setRegisterValue(regist,
-                                                    *instruction.parameters.at(1));
-                            break;
-                        }
-                        case 2:
-                        {
-                            factory.setVariableValue(*std::get<sharedt<rs_variable>>(reg), *instruction.parameters.at(1));
-                        }
+                case rbc_instruction::ENDIF:
+                case rbc_instruction::DEC:
+                case rbc_instruction::ENDAS:
+                case rbc_instruction::ENDFOR:
+                    depth--;
+                    break;
+                default:
+                    break;
+            }
+        }
+        mcprogram.cachedSelectors.clear();
+        if (!cache)
+            return;
+        for(auto& [selector, uses] : runs)
+        {
+            if (!mc_cacheable_selector(selector))
+                continue;
+            for(auto& run : uses)
+            {
+                if (run.size() < RS_SELECTOR_CACHE_USES)
+                    continue;
+                const std::string tag = RBC_SELECTOR_TAG + STR(mcprogram.selectorTags++);
+                selectorTagsAt[run.front()] = {selector, tag};
+                for(rbc_constant* c : run)
+                    c->val = mc_tagged_selector(selector, tag);
+            }
+        }
+    };
+    // tags the entities of a cached selector if the instruction is its first use.
+    auto tagSelector = [&](rbc_command& instruction)
+    {
+        rbc_constant* selector = selectorOf(instruction);
+        auto found = selector ? selectorTagsAt.find(selector) : selectorTagsAt.end();
+        if (found == selectorTagsAt.end())
+            return;
+        auto& [original, tag] = found->second;
+        factory.create_and_push(MC_TAG_CMD_ID, MC_TAG_ADD(original, tag));
+        mcprogram.cachedSelectors.push_back({selector->val, tag});
+        selectorTagsAt.erase(found);
+    };
+
+    std::function<mccmdlist(std::vector<rbc_command>&)> parseFunction;
+    // arguments pushed to the inbuilt functions being called, handed to them by the call.
+    std::unordered_map<rbc_function*, std::vector<rbc_value>> intrinsicArguments;
+    // function being converted, null for the global function.
+    rbc_function* owner = nullptr;
+
+    // converts the instructions [from, to) on their own. they are only reached when their conditions
+    // are met, so they are parsed without them. a block run in another context (as/at) or more than once (for)
+    // caches its own selectors.
+    auto parseDetached = [&](std::vector<rbc_command>& instructions, size_t from, size_t to, const bool context = false) -> mccmdlist
+    {
+        std::vector<rbc_command> body(instructions.begin() + from, instructions.begin() + to);
+        auto cached = context ? std::move(mcprogram.cachedSelectors) : decltype(mcprogram.cachedSelectors){};
+        if (context)
+            cacheSelectors(body, !owner || !owner->recursive);
+        // the block's variables are removed at its end.
+        body.insert(body.begin(), rbc_command(rbc_instruction::INC));
+        body.push_back(rbc_command(rbc_instruction::DEC));
+
+        mccmdlist outer = factory.detach();
+        auto blocks = std::move(mcprogram.blocks);
+        mcprogram.blocks = {};
+        mccmdlist commands = parseFunction(body);
+        // the tags of the block's selectors are removed when the block's function ends.
+        if (context)
+        {
+            factory.uncacheSelectors();
+            mccmdlist uncached = factory.package();
+            factory.clear();
+            commands.insert(commands.end(), uncached.begin(), uncached.end());
+            mcprogram.cachedSelectors = std::move(cached);
+        }
+        mcprogram.blocks = std::move(blocks);
+        factory.reattach(outer);
+        return commands;
+    };
+    // adds a function next to the one being converted, returning the arguments of the command calling it.
+    auto addOutlined = [&](mccmdlist commands) -> std::string
+    {
+        mc_function f{(owner ? owner->name : RS_OUTLINED_GLOBAL_NAME) + "_b" + STR(mcprogram.outlinedFunctions++),
+                      commands,
+                      owner ? owner->modulePath : std::vector<std::string>{}};
+        if (owner)
+            f.parentalHashStr = owner->getParentHashStr();
+        mcprogram.functions.push_back(f);
+
+        std::string call = factory.functionPath(moduleName, f.modulePath, f.parentalHashStr, f.name);
+        if (owner && !owner->macroArguments.empty() && std::any_of(commands.begin(), commands.end(), [](mc_command& c) { return c.macro; }))
+            call += MC_FUNCTION_WITH(owner->macroArguments);
+        return call;
+    };
+    // compares two values into a comparison register, for the terms that can't be tested in place.
+    auto registerTerm = [&](rbc_value& lhs, const bool eq, rbc_value& rhs) -> std::shared_ptr<comparison_register>
+    {
+        // commutative check, as no values are modified
+        std::shared_ptr<comparison_register> usedRegister = nullptr;
+        if (lhs.index() == rhs.index())
+        {
+            switch(lhs.index())
+            {
+                case 0:
+                {
+                    // two constants.
+                    WARN("Comparing two constants is not good practice.");
+                    break;
+                }
+                case 1:
+                {
+                    // two registers
+                    rbc_register& reg  = *std::get<1>(lhs);
+                    rbc_register& reg2 = *std::get<1>(rhs);
+
+                    if ((reg.operable && !reg2.operable) || (!reg.operable && reg2.operable))
+                    {
+                        // store result in storage and compare
+                        rbc_register& operable =  reg2.operable ? reg2 : reg;
+                        rbc_register& noperable = reg2.operable ? reg  : reg2; 
+                        factory.add( factory.getRegisterValue(noperable).storeResult(PADR(score) + MC_TEMP_SCOREBOARD_STORAGE) );
+
+                        usedRegister = factory.compare("score", MC_OPERABLE_REG(INS_L(STR(operable.id))), eq, MC_TEMP_SCOREBOARD_STORAGE);
                     }
+                    // both are either operable or not operable
+                    else if (reg.operable)
+                        usedRegister = factory.compare("score", MC_OPERABLE_REG(INS_L(STR(reg.id))), eq, MC_OPERABLE_REG(INS_L(STR(reg2.id))));
+                    else // TODO fix NOPERABLE_REG_GET: not raw, has extra commands at start
+                        usedRegister = factory.compare("data", MC_NOPERABLE_REG_GET(reg.id), eq, MC_NOPERABLE_REG_GET(reg2.id));
                     break;
                 }
-                case rbc_instruction::MATH:
+                case 2:
                 {
-                    RS_ASSERT_SIZE(size > 2);
-                    rbc_constant& val = std::get<rbc_constant>(*instruction.parameters.at(2));
-                    bst_operation_type operation = bst_operation_type::NONE;
-                    int operatorID = std::stoi(val.val);
-                    switch(operatorID)
+                    rs_variable& var  = *std::get<2>(lhs);
+                    rs_variable& var2 = *std::get<2>(rhs);
+
+                    if (var.comp_info.scoreboard && var2.comp_info.scoreboard)
+                        usedRegister = factory.compare("score", factory.variablePath(var), eq, factory.variablePath(var2));
+                    else if (var.comp_info.scoreboard || var2.comp_info.scoreboard)
                     {
-                        case 0:
-                            operation = bst_operation_type::ADD;
-                            break;
-                        case 1:
-                            operation = bst_operation_type::SUB;
-                            break;
-                        case 2:
-                            operation = bst_operation_type::MUL;
-                            break;
-                        case 3:
-                            operation = bst_operation_type::DIV;
-                            break;
-                        case 4:
-                            operation = bst_operation_type::MOD;
-                            break;
-                        case 5:
-                            operation = bst_operation_type::XOR;
-                            break;
-                        case 6:
-                            operation = bst_operation_type::POW;
-                            break;
+                        rs_variable& score   = var.comp_info.scoreboard ? var : var2;
+                        rs_variable& storage = var.comp_info.scoreboard ? var2 : var;
+                        factory.add( factory.getVariableValue(storage).storeResult(PADR(score) + MC_TEMP_SCOREBOARD_STORAGE) );
+                        usedRegister = factory.compare("score", factory.variablePath(score), eq, MC_TEMP_SCOREBOARD_STORAGE);
                     }
-                    factory.math(*instruction.parameters.at(0), *instruction.parameters.at(1), operation); 
+                    else
+                        usedRegister = factory.compare("data", factory.variablePath(var), eq, factory.variablePath(var2));
+
                     break;
                 }
-                case rbc_instruction::CALL:
+                default:
+                    WARN("Unimplemented comparison.");
+            }
+        }
+        else
+        {
+            {
+            result_pair<sharedt<rbc_register>, rbc_constant> res = 
+                commutativeVariantEquals<sharedt<rbc_register>, rbc_constant, rbc_value>(1, lhs, 0, rhs);
+            if (res)
+            {
+                rbc_register& reg = *(*res.i1);
+                rbc_constant& con =   *res.i2;
+
+                if (reg.operable)
                 {
-                    RS_ASSERT_SIZE(size > 0);
-                    std::shared_ptr<rbc_function> f = nullptr;
+                    usedRegister = factory.compare("score", MC_OPERABLE_REG(INS_L(STR(reg.id))), eq, con.val, true);
+                }
+                else
+                {
+                    factory.create_and_push(MC_DATA_CMD_ID, MC_TEMP_STORAGE_SET_CONST(con.val));
+                    // TODO: fix to not have leading keywords!
+                    usedRegister = factory.compare("data", MC_NOPERABLE_REG_GET(reg.id), eq, MC_TEMP_STORAGE);
+                }
+                return usedRegister;
+            }
+            }
+            {
+            result_pair<sharedt<rbc_register>, sharedt<rs_variable>> res = 
+                commutativeVariantEquals<sharedt<rbc_register>, sharedt<rs_variable>, rbc_value>(1, lhs, 2, rhs);
+
+            if (res)
+            {
+                rbc_register& reg = *(*res.i1);
+                rs_variable&  var = *(*res.i2);
+
+                if (var.comp_info.scoreboard)
+                {
+                    if (!reg.operable)
+                        factory.add( factory.getRegisterValue(reg).storeResult(PADR(score) + MC_TEMP_SCOREBOARD_STORAGE) );
+                    usedRegister = factory.compare("score", factory.variablePath(var), eq,
+                                        reg.operable ? MC_OPERABLE_REG(INS_L(STR(reg.id))) : MC_TEMP_SCOREBOARD_STORAGE);
+                    return usedRegister;
+                }
+                if (reg.operable)
+                    factory.getRegisterValue(reg).storeResult(PADR(storage) MC_TEMP_STORAGE, "int", 1);
+                else
+                    factory.copyStorage(MC_TEMP_STORAGE, MC_NOPERABLE_REG_GET(reg.id));
+                usedRegister = factory.compare("data", factory.variablePath(var), eq, MC_TEMP_STORAGE);
+                return usedRegister;
+            }
+            }
+            {
+            result_pair<sharedt<rs_variable>, rbc_constant> res = 
+                commutativeVariantEquals<sharedt<rs_variable>, rbc_constant, rbc_value>(2, lhs, 0, rhs);
+
+            if (res)
+            {
+                rs_variable&  var = *(*res.i1);
+                rbc_constant& con = *res.i2;
+                
+                // a fixed point score is compared to the constant at its scale.
+                const int scale = conversion::CommandFactory::fixedScale(var.type_info);
+                if (var.comp_info.scoreboard && scale != 1)
+                    usedRegister = factory.compare("score", factory.variablePath(var), eq, STR(std::llround(std::stod(con.val) * scale)), true);
+                else if (var.comp_info.scoreboard)
+                    usedRegister = factory.compare("score", factory.variablePath(var), eq, con.val, true);
+                else
+                    usedRegister = factory.compare("data", factory.variablePath(var), eq, con.val, true);
+                return usedRegister;
+            }
+            }
+        }
+        return usedRegister;
+    };
+    // tests a single value for not being 0 or null into a comparison register.
+    auto registerNull = [&](rbc_value& value) -> std::shared_ptr<comparison_register>
+    {
+        switch(value.index())
+        {
+            case 1:
+            {
+                rbc_register& reg = *std::get<1>(value);
+                if (reg.operable)
+                    return factory.compareNull(true, MC_OPERABLE_REG(INS_L(STR(reg.id))), true);
+                return factory.compareNull(false, MC_NOPERABLE_REG(reg.id), true);
+            }
+            case 2:
+            {
+                rs_variable& var = *std::get<2>(value);
+                return factory.compareNull(var.comp_info.scoreboard, factory.variablePath(var), true);
+            }
+            default:
+                ERROR("Cannot compare rbc_value of unimplemented typeid to null. If you see this error, flag an issue.");
+                return nullptr;
+        }
+    };
+    // lowers the condition of an IF/ELIF into execute subcommands. `and` stacks the subcommands of its terms,
+    // `or` is tested by a predicate function returning on the first group that matches. registers compared
+    // into are added to used, and have to be freed once the condition was tested.
+    auto lowerCondition = [&](rbc_command& instruction, std::vector<std::shared_ptr<comparison_register>>& used) -> rbc_condition
+    {
+        struct term
+        {
+            bool negate = false;
+            rbc_value* lhs = nullptr;
+            std::string op;
+            rbc_value* rhs = nullptr;
+        };
+        // or-separated groups of and-joined terms.
+        std::vector<std::vector<term>> groups(1);
+        term current;
+        for(auto& param : instruction.parameters)
+        {
+            if (param->index() == 0)
+            {
+                rbc_constant& c = std::get<0>(*param);
+                switch(c.val_type)
+                {
+                    case token_type::KW_NOT:
+                        current.negate = !current.negate;
+                        continue;
+                    case token_type::COMPARE_EQUAL:
+                    case token_type::COMPARE_NOTEQUAL:
+                        current.op = c.val;
+                        continue;
+                    case token_type::KW_AND:
+                    case token_type::KW_OR:
+                        groups.back().push_back(current);
+                        current = term{};
+                        if (c.val_type == token_type::KW_OR)
+                            groups.emplace_back();
+                        continue;
+                    default:
+                        break;
+                }
+            }
+            (current.op.empty() ? current.lhs : current.rhs) = param.get();
+        }
+        groups.back().push_back(current);
 
-                    rbc_value& p0 = *instruction.parameters.at(0);
-                    std::string name;
-                    if (p0.index() == 0)
+        // the score holder of a value, empty if it doesn't live on a scoreboard.
+        auto scoreOf = [&](rbc_value& value) -> std::string
+        {
+            if (value.index() == 1 && std::get<1>(value)->operable)
+                return MC_OPERABLE_REG(INS_L(STR(std::get<1>(value)->id)));
+            if (value.index() == 2 && std::get<2>(value)->comp_info.scoreboard)
+                return factory.variablePath(*std::get<2>(value));
+            return "";
+        };
+        // a storage path split into `parent{key:...}`. an element of a list can't be filtered by its index, so its value
+        // is copied to terms.t<n> (one per term, as they're all tested by the same command) and filtered there.
+        // empty if the path is only known at runtime.
+        uint terms = 0;
+        auto filterOf = [&](rbc_value& value, const std::string& match) -> std::string
+        {
+            if (value.index() != 2 || std::get<2>(value)->comp_info.scoreboard)
+                return "";
+            const std::string path = factory.variablePath(*std::get<2>(value));
+            if (path.find('$') != std::string::npos)
+                return "";
+            const size_t dot = path.rfind('.');
+            if (dot != std::string::npos && path.at(dot - 1) != ']' && path.back() != ']')
+                return "data storage " RS_PROGRAM_STORAGE SEP + path.substr(0, dot) + '{' + path.substr(dot + 1) + ':' + match + '}';
+            factory.copyStorage(MC_CONDITION_TERM(terms), path);
+            return "data storage " RS_PROGRAM_STORAGE SEP MC_CONDITION_TERM_FILTER(terms++, match);
+        };
+        auto isInt = [](rbc_value& value)
+        {
+            return value.index() == 0 && std::get<0>(value).val_type == token_type::INT_LITERAL;
+        };
+        auto lowerTerm = [&](term& t) -> rbc_condition
+        {
+            const bool positive = (t.op != "!=") != t.negate;
+            const std::string test = positive ? "if " : "unless ";
+            rbc_value& lhs = *t.lhs;
+            if (t.op.empty())
+            {
+                if (lhs.index() == 0)
+                {
+                    rbc_constant& c = std::get<0>(lhs);
+                    if (c.val_type != token_type::INT_LITERAL)
                     {
-                        name = std::get<rbc_constant>(*instruction.parameters.at(0)).val;
-                        rs_module* fromModule = nullptr;
-                        if (size > 1)
+                        err = std::format("Cannot convert typeid {} to boolean.", static_cast<int>(c.val_type));
+                        return {};
+                    }
+                    return rbc_condition{"", (std::stoi(c.val) != 0) == positive};
+                }
+                const std::string score = scoreOf(lhs);
+                if (!score.empty())
+                    return rbc_condition{(positive ? "unless score " : "if score ") + score + " matches 0"};
+                const std::string zero = positive ? filterOf(lhs, "0") : "";
+                if (!zero.empty())
+                    return rbc_condition{"if data storage " RS_PROGRAM_STORAGE SEP + factory.variablePath(*std::get<2>(lhs)) + " unless " + zero};
+
+                auto reg = registerNull(lhs);
+                if (!reg)
+                    return {};
+                used.push_back(reg);
+                return rbc_condition{factory.testRegister(*reg, !positive)};
+            }
+            rbc_value& rhs = *t.rhs;
+            if (lhs.index() == 0 && rhs.index() == 0)
+            {
+                WARN("Comparing two constants is not good practice.");
+                return rbc_condition{"", (std::get<0>(lhs).val == std::get<0>(rhs).val) == positive};
+            }
+            // constants on the right
+            rbc_value& value = lhs.index() == 0 ? rhs : lhs;
+            rbc_value& other = lhs.index() == 0 ? lhs : rhs;
+
+            const std::string score = scoreOf(value);
+            if (!score.empty() && isInt(other))
+                return rbc_condition{test + "score " + score + " matches " + std::get<0>(other).val};
+            const std::string otherScore = scoreOf(other);
+            if (!score.empty() && !otherScore.empty())
+                return rbc_condition{test + "score " + score + " = " + otherScore};
+            if (other.index() == 0)
+            {
+                rbc_constant c = std::get<0>(other);
+                c.quoteIfStr();
+                const std::string filter = filterOf(value, c.val);
+                if (!filter.empty())
+                    return rbc_condition{test + filter};
+            }
+
+            auto reg = registerTerm(lhs, t.op != "!=", rhs);
+            if (!reg)
+                return {};
+            used.push_back(reg);
+            return rbc_condition{factory.testRegister(*reg, t.negate)};
+        };
+
+        // each group is a conjunction of its terms' subcommands.
+        std::vector<std::string> alternatives;
+        for(auto& group : groups)
+        {
+            rbc_condition conjunction{"", 1};
+            for(auto& t : group)
+            {
+                if (!t.lhs || (!t.op.empty() && !t.rhs))
+                {
+                    err = "Expected expression in condition.";
+                    return {};
+                }
+                rbc_condition lowered = lowerTerm(t);
+                if (!err.empty())
+                    return {};
+                if (lowered.constant == 1)
+                    continue;
+                if (lowered.constant == 0)
+                {
+                    conjunction = rbc_condition{"", 0};
+                    break;
+                }
+                conjunction.subcommands += (conjunction.subcommands.empty() ? "" : " ") + lowered.subcommands;
+                conjunction.constant = -1;
+            }
+            if (conjunction.constant == 1)
+                return conjunction;
+            if (conjunction.constant == -1)
+                alternatives.push_back(conjunction.subcommands);
+        }
+        if (alternatives.empty())
+            return rbc_condition{"", 0};
+        if (alternatives.size() == 1)
+            return rbc_condition{alternatives.front()};
+
+        if (factory.supports(mc_feature::EXECUTE_IF_FUNCTION))
+        {
+            // returns on the first group that matches, the others aren't tested.
+            mccmdlist predicate;
+            for(auto& alternative : alternatives)
+                predicate.push_back(mc_command{false, MC_EXEC_CMD_ID, "execute " + alternative + " run return 1"});
+            predicate.push_back(mc_command{false, MC_RETURN_CMD_ID, "return 0"});
+            return rbc_condition{"if function " + addOutlined(predicate)};
+        }
+        // no `execute if function`, latched into a register the later groups stop at.
+        for(auto& reg : used)
+            reg->free();
+        used.clear();
+        auto latch = factory.getFreeComparisonRegister();
+        latch->vacant = false;
+        latch->operation = comparison_operation_type::EQ;
+        factory.create_and_push(MC_SCOREBOARD_CMD_ID, MC_COMPARE_RESET(latch->id));
+        for(auto& alternative : alternatives)
+            factory.create_and_push(MC_EXEC_CMD_ID, "unless " MC_COMPARE_REG_TEST(latch->id) SEP + alternative + " run scoreboard " MC_COMPARE_REG_SET(latch->id, "1"));
+        used.push_back(latch);
+        return rbc_condition{factory.testRegister(*latch)};
+    };
+    // large if/else blocks are moved into their own functions, so their condition is tested once instead of
+    // in front of every command. the else block is placed after a `return run` on the if block.
+    auto outlineBranch = [&](std::vector<rbc_command>& instructions, size_t& i, const std::string& condition) -> bool
+    {
+        size_t depth = 0, elseAt = 0, end = 0;
+        for(size_t c = i + 1; c < instructions.size() && !end; c++)
+        {
+            switch(instructions.at(c).type)
+            {
+                case rbc_instruction::IF:
+                case rbc_instruction::NIF:
+                    depth++;
+                    break;
+                case rbc_instruction::ENDIF:
+                    if (depth == 0)
+                        end = c;
+                    else
+                        depth--;
+                    break;
+                case rbc_instruction::ELSE:
+                    if (depth == 0)
+                        elseAt = c;
+                    break;
+                // elif chains and returns are left inline, a return would only leave the outlined function.
+                case rbc_instruction::ELIF:
+                case rbc_instruction::NELIF:
+                    if (depth == 0)
+                        return false;
+                    break;
+                case rbc_instruction::RET:
+                    return false;
+                default:
+                    break;
+            }
+        }
+        const size_t threshold = RS_CONFIG.exists("outline") ? RS_CONFIG.get<int>("outline") : RS_OUTLINE_THRESHOLD;
+        if (!end || end - i - 1 - (elseAt ? 1 : 0) < threshold)
+            return false;
+        // the else block is reached through `return run`.
+        if (elseAt && !factory.supports(mc_feature::RETURN_RUN))
+            return false;
+
+        // the condition is tested once, before anything in the block runs.
+        const std::string prefix = condition.empty() ? "" : "execute " + condition + " run ";
+        mc_command call{false, MC_FUNCTION_CMD_ID, ""};
+        if (!elseAt)
+        {
+            call.body = addOutlined(parseDetached(instructions, i + 1, end));
+            if (!condition.empty())
+                call = mc_command{false, MC_EXEC_CMD_ID, condition + " run function " + call.body};
+        }
+        else
+        {
+            // `return run function` has to return, even if the if block falls through.
+            mccmdlist ifBody = parseDetached(instructions, i + 1, elseAt);
+            ifBody.push_back(mc_command{false, MC_RETURN_CMD_ID, "return 0"});
+
+            mc_command branch{false, MC_RETURN_CMD_ID, prefix + "return run function " + addOutlined(ifBody)};
+
+            mccmdlist dispatch = parseDetached(instructions, elseAt + 1, end);
+            dispatch.insert(dispatch.begin(), branch);
+            call.body = addOutlined(dispatch);
+        }
+        factory.add(call);
+        i = end;
+        return true;
+    };
+    // if/elif chains comparing one int to constants are dispatched on its score, through a binary tree of
+    // `matches` ranges, or a macro jump table when the constants are dense enough.
+    auto dispatchChain = [&](std::vector<rbc_command>& instructions, size_t& i) -> bool
+    {
+        // reads `x == <int>`, x has to be the same variable for every condition.
+        auto caseOf = [](rbc_command& condition, rs_variable*& var, int& value) -> bool
+        {
+            if (condition.parameters.size() != 3 || condition.parameters.at(1)->index() != 0
+            ||  std::get<rbc_constant>(*condition.parameters.at(1)).val != "==")
+                return false;
+            rbc_value& lhs = *condition.parameters.at(0);
+            rbc_value& rhs = *condition.parameters.at(2);
+            rbc_value& v = lhs.index() == 2 ? lhs : rhs;
+            rbc_value& c = lhs.index() == 2 ? rhs : lhs;
+            if (v.index() != 2 || c.index() != 0 || std::get<rbc_constant>(c).val_type != token_type::INT_LITERAL)
+                return false;
+            rs_variable* found = std::get<2>(v).get();
+            if ((var && var != found) || (!found->comp_info.scoreboard && found->type_info.type_id != RS_INT_KW_ID))
+                return false;
+            var   = found;
+            value = std::stoi(std::get<rbc_constant>(c).val);
+            return true;
+        };
+        // the bodies are called from their own functions, which would not receive the owner's macro arguments.
+        if (owner && !owner->macroArguments.empty())
+            return false;
+        // cases leave through `return run`.
+        if (!factory.supports(mc_feature::RETURN_RUN))
+            return false;
+
+        rs_variable* var = nullptr;
+        int value;
+        if (!caseOf(instructions.at(i), var, value))
+            return false;
+
+        // value: [from, to) of its body, the first one wins for repeated values.
+        std::map<int, std::pair<size_t, size_t>> cases;
+        size_t depth = 0, start = i + 1, elseAt = 0, end = 0;
+        for(size_t c = i + 1; c < instructions.size() && !end; c++)
+        {
+            switch(instructions.at(c).type)
+            {
+                case rbc_instruction::IF:
+                case rbc_instruction::NIF:
+                    depth++;
+                    break;
+                case rbc_instruction::ENDIF:
+                    if (depth == 0)
+                        end = c;
+                    else
+                        depth--;
+                    break;
+                case rbc_instruction::ELIF:
+                    if (depth > 0)
+                        break;
+                    cases.emplace(value, std::make_pair(start, c));
+                    if (!caseOf(instructions.at(c), var, value))
+                        return false;
+                    start = c + 1;
+                    break;
+                case rbc_instruction::NELIF:
+                    if (depth == 0)
+                        return false;
+                    break;
+                case rbc_instruction::ELSE:
+                    if (depth > 0)
+                        break;
+                    cases.emplace(value, std::make_pair(start, c));
+                    elseAt = c;
+                    break;
+                // a return would only leave the function of its case.
+                case rbc_instruction::RET:
+                    return false;
+                default:
+                    break;
+            }
+        }
+        if (!end)
+            return false;
+        if (!elseAt)
+            cases.emplace(value, std::make_pair(start, end));
+        if (cases.size() < RS_DISPATCH_MIN_CASES)
+            return false;
+
+        std::string score = factory.variablePath(*var);
+        if (!var->comp_info.scoreboard)
+        {
+            factory.add(factory.getVariableValue(*var).storeResult(PADR(score) + MC_TEMP_SCOREBOARD_STORAGE));
+            score = MC_TEMP_SCOREBOARD_STORAGE;
+        }
+        // every body has to return, so a case that was run is never followed by the else block.
+        auto caseBody = [&](std::pair<size_t, size_t> range) -> mccmdlist
+        {
+            mccmdlist body = parseDetached(instructions, range.first, range.second);
+            body.push_back(mc_command{false, MC_RETURN_CMD_ID, "return 1"});
+            return body;
+        };
+        const std::string miss = elseAt ? "return run function " + addOutlined(caseBody({elseAt + 1, end})) : "return 0";
+        auto matches = [&](const std::string& range, const std::string& run) -> mc_command
+        {
+            return mc_command{false, MC_EXEC_CMD_ID, "execute if score " + score + " matches " + range + " run " + run};
+        };
+
+        const int64_t min = cases.begin()->first, max = cases.rbegin()->first;
+        const double density = cases.size() / double(max - min + 1);
+        const uint treeCost  = std::ceil(std::log2(cases.size())) + 1;
+        const uint tableCost = RS_MACRO_CALL_COST + 2;
+
+        std::string root;
+        if (factory.supports(mc_feature::MACROS) && density >= RS_JUMP_TABLE_DENSITY && tableCost < treeCost)
+        {
+            // every value in range gets a function named after it, `<function>_t<n>/<value>`.
+            std::vector<std::string> table = owner ? owner->modulePath : std::vector<std::string>{};
+            const std::string hash = owner ? owner->getParentHashStr() : "";
+            table.push_back((hash.empty() ? "" : hash + '_') + (owner ? owner->name : RS_OUTLINED_GLOBAL_NAME) + "_t" + STR(mcprogram.outlinedFunctions++));
+
+            for(int64_t v = min; v <= max; v++)
+            {
+                auto found = cases.find(v);
+                mc_function entry{std::to_string(v),
+                                  found == cases.end() ? mccmdlist{mc_command{false, MC_RETURN_CMD_ID, miss}} : caseBody(found->second),
+                                  table};
+                mcprogram.functions.push_back(entry);
+            }
+            std::string path = factory.functionPath(moduleName, table, "", "");
+            path.pop_back(); // trailing '/'
+
+            root = addOutlined({
+                mc_command{false, MC_EXEC_CMD_ID, "execute unless score " + score + " matches " + STR(min) + ".." + STR(max) + " run " + miss},
+                mc_command{false, MC_EXEC_CMD_ID, "execute store result storage " RS_PROGRAM_STORAGE SEP MC_SWITCH_ARGUMENTS ".v int 1 run scoreboard players get " + score},
+                mc_command{false, MC_RETURN_CMD_ID, "return run function " + addOutlined({mc_command{true, MC_RETURN_CMD_ID, "return run function " + path + '/' + MC_MACRO("v")}})
+                                                    + MC_FUNCTION_WITH(MC_SWITCH_ARGUMENTS)}
+            });
+        }
+        else
+        {
+            std::vector<std::pair<int, std::string>> targets;
+            for(auto& c : cases)
+                targets.push_back({c.first, addOutlined(caseBody(c.second))});
+
+            // halves the cases until few enough are left to test one by one.
+            std::function<std::string(size_t, size_t)> node = [&](size_t lo, size_t hi) -> std::string
+            {
+                mccmdlist commands;
+                if (hi - lo < RS_DISPATCH_LEAF_CASES)
+                {
+                    for(size_t c = lo; c <= hi; c++)
+                        commands.push_back(matches(STR(targets.at(c).first), "return run function " + targets.at(c).second));
+                    commands.push_back(mc_command{false, MC_RETURN_CMD_ID, miss});
+                }
+                else
+                {
+                    const size_t mid = (lo + hi) / 2;
+                    commands.push_back(matches(".." + STR(targets.at(mid).first), "return run function " + node(lo, mid)));
+                    commands.push_back(mc_command{false, MC_RETURN_CMD_ID, "return run function " + node(mid + 1, hi)});
+                }
+                return addOutlined(commands);
+            };
+            root = node(0, targets.size() - 1);
+        }
+        mc_command call{false, MC_FUNCTION_CMD_ID, root};
+        factory.add(call);
+        i = end;
+        return true;
+    };
+    // the operator of a MATH instruction, given by its id.
+    auto mathOperation = [](rbc_command& instruction) -> bst_operation_type
+    {
+        rbc_constant& val = std::get<rbc_constant>(*instruction.parameters.at(2));
+        switch(std::stoi(val.val))
+        {
+            case 0:
+                return bst_operation_type::ADD;
+            case 1:
+                return bst_operation_type::SUB;
+            case 2:
+                return bst_operation_type::MUL;
+            case 3:
+                return bst_operation_type::DIV;
+            case 4:
+                return bst_operation_type::MOD;
+            case 5:
+                return bst_operation_type::XOR;
+            case 6:
+                return bst_operation_type::POW;
+        }
+        return bst_operation_type::NONE;
+    };
+    // SAVE r, x; MATH r, v; SAVE x, r on a score, as one command done to the score.
+    auto operateInPlace = [&](std::vector<rbc_command>& instructions, size_t& i) -> bool
+    {
+        if (i + 2 >= instructions.size())
+            return false;
+        rbc_command& load = instructions.at(i), &math = instructions.at(i + 1), &store = instructions.at(i + 2);
+        auto same = [](rbc_value& a, rbc_value& b) { return a.index() == b.index() && (a.index() == 1 || a.index() == 2)
+            && (a.index() == 1 ? std::get<1>(a) == std::get<1>(b) : std::get<2>(a) == std::get<2>(b)); };
+        if (load.parameters.size() != 2 || load.parameters.at(0)->index() != 1 || load.parameters.at(1)->index() != 2
+            || math.type != rbc_instruction::MATH || math.parameters.size() < 3 || !same(*math.parameters.at(0), *load.parameters.at(0))
+            || store.type != rbc_instruction::SAVE || store.parameters.size() != 2
+            || !same(*store.parameters.at(0), *load.parameters.at(1)) || !same(*store.parameters.at(1), *load.parameters.at(0)))
+            return false;
+        rs_variable& var = *std::get<2>(*load.parameters.at(1));
+        if (!factory.operateScore(var, *math.parameters.at(1), mathOperation(math)))
+            return false;
+        std::get<1>(*load.parameters.at(0))->free();
+        i += 2;
+        return true;
+    };
+    // SAVE r, x; MATH r, c where the result doesn't depend on x (x * 0, x % 1), so x isn't read into the register.
+    auto foldOperand = [&](std::vector<rbc_command>& instructions, size_t& i) -> bool
+    {
+        if (i + 1 >= instructions.size())
+            return false;
+        rbc_command& load = instructions.at(i), &math = instructions.at(i + 1);
+        if (load.parameters.size() != 2 || load.parameters.at(1)->index() == 1
+            || math.type != rbc_instruction::MATH || math.parameters.size() < 3 || math.parameters.at(1)->index() != 0
+            || math.parameters.at(0)->index() != 1 || std::get<1>(*math.parameters.at(0)) != std::get<1>(*load.parameters.at(0)))
+            return false;
+        rbc_register& reg = *std::get<1>(*load.parameters.at(0));
+        rbc_value& operand = *load.parameters.at(1);
+        rbc_constant& c = std::get<0>(*math.parameters.at(1));
+        if (!reg.operable || c.val_type != token_type::INT_LITERAL)
+            return false;
+        int scale = 1;
+        if (operand.index() == 0 && std::get<0>(operand).val_type == token_type::FLOAT_LITERAL)
+            scale = RS_FLOAT_SCALE;
+        else if (operand.index() == 2)
+        {
+            rs_variable& var = *std::get<2>(operand);
+            if (var.type_info.type_id != RS_INT_KW_ID && var.type_info.type_id != RS_FLOAT_KW_ID)
+                return false;
+            scale = conversion::CommandFactory::fixedScale(var.type_info);
+        }
+        else if (operand.index() != 0 || std::get<0>(operand).val_type != token_type::INT_LITERAL)
+            return false;
+        // the remainder of a fixed point value by 1 is its fraction.
+        const bst_operation_type t = mathOperation(math);
+        const int factor = std::stoi(c.val);
+        if (!(t == bst_operation_type::MUL && factor == 0) && !(t == bst_operation_type::MOD && std::abs(factor) == 1 && scale == 1))
+            return false;
+        factory.create_and_push(MC_SCOREBOARD_CMD_ID, MC_OPERABLE_REG_SET(reg.id, "0"));
+        reg.scale = scale;
+        reg.free();
+        i++;
+        return true;
+    };
+    parseFunction = [&](std::vector<rbc_command>& instructions) -> mccmdlist
+    {
+        for(size_t i = 0; i < instructions.size(); i++)
+        {
+            auto& instruction = instructions.at(i);
+            const size_t size = instruction.parameters.size();
+
+            tagSelector(instruction);
+            if (instruction.type == rbc_instruction::IF && dispatchChain(instructions, i))
+                continue;
+
+            switch(instruction.type)
+            {
+                case rbc_instruction::CREATE:
+                {
+                    RS_ASSERT_SIZE(size > 0);
+                    rs_variable& var = *std::get<sharedt<rs_variable>>(*instruction.parameters.at(0));
+                    // created by the load function, only values known at runtime are left to write.
+                    if (var.comp_info.loaded)
+                    {
+                        if (instruction.parameters.size() > 1 && instruction.parameters.at(1)->index() != 0)
+                            factory.setVariableValue(var, *instruction.parameters.at(1));
+                        break;
+                    }
+                    // the value and type are written by the SAVERET that follows.
+                    if (instruction.parameters.size() == 1 && i + 1 < instructions.size() && instructions.at(i + 1).type == rbc_instruction::SAVERET)
+                        factory.allocateVariable(var, false);
+                    else if (instruction.parameters.size() == 1)
+                        factory.createVariable(var);
+                    else
+                    {
+                        rbc_value& val = *instruction.parameters.at(1);
+                        factory.createVariable(var, val);
+                    }
+                    // RS_ASSERT_SUCCESS;
+                    break;
+                }
+                case rbc_instruction::SAVE:
+                {
+                    RS_ASSERT_SIZE(size == 2);
+                    rbc_value& reg = *instruction.parameters.at(0);
+                    switch(reg.index())
+                    {
+                        // register
+                        case 1:
                         {
-                            fromModule = (rs_module*) std::get<std::shared_ptr<void>>(*instruction.parameters.at(1)).get();
-                            
-                            if(!fromModule)
-                            {
-                                err = "Function defined in module has caused seg fault. Flag this error on the github, it should not occur.";
+                            if (operateInPlace(instructions, i) || foldOperand(instructions, i))
                                 break;
-                            }
-                            else
-                                f = fromModule->functions.find(name)->second;
+                            rbc_register& regist = *std::get<sharedt<rbc_register>>(reg);
+                            regist.vacant = false;
+                            factory.setRegisterValue(regist,
+                                                    *instruction.parameters.at(1));
+                            break;
+                        }
+                        case 2:
+                        {
+                            factory.setVariableValue(*std::get<sharedt<rs_variable>>(reg), *instruction.parameters.at(1));
                         }
-                        else
-                            f = program.functions.find(name)->second;
                     }
-                    else
+                    break;
+                }
+                case rbc_instruction::MATH:
+                {
+                    RS_ASSERT_SIZE(size > 2);
+                    factory.math(*instruction.parameters.at(0), *instruction.parameters.at(1), mathOperation(instruction));
+                    break;
+                }
+                case rbc_instruction::CALL:
+                {
+                    RS_ASSERT_SIZE(size > 0);
+                    std::shared_ptr<rbc_function> f = resolveCall(instruction);
+                    if (!f)
                     {
-                        std::shared_ptr<void> func = std::get<std::shared_ptr<void>>(p0);
-                        f = std::static_pointer_cast<rbc_function>(func);
-                        name = f->name;
+                        err = "Function defined in module has caused seg fault. Flag this error on the github, it should not occur.";
+                        break;
                     }
                     rbc_function& func = *f;
-                    factory.disableBuffer();
+                    const std::string& name = func.name;
                     
                     if (std::find(func.decorators.begin(), func.decorators.end(), rbc_function_decorator::CPP) != func.decorators.end())
                     {
-                        long caret = i;
-                        std::vector<rbc_value> parameters;
-                        rbc_command* cmd;
-
-                        // we dont need the parameter instructions anymore.
-                        factory.clearBuffer();
-                        while(--caret >= 0 && (cmd = &instructions.at(caret))->type == rbc_instruction::PUSH)
-                        {
-                            parameters.push_back(*cmd->parameters.at(2));
-                            mcprogram.varStackCount--;
-                        }
-                        std::vector<rbc_value> reversed;
-                        reversed.reserve(parameters.size());
-
-                        for (auto it = parameters.rbegin(); it != parameters.rend(); ++it) {
-                            reversed.push_back(std::move(*it));
-                        }
-                        parameters = std::move(reversed);
-                        auto decl = inb_impls::INB_IMPLS_MAP.find(name);
+                        std::vector<rbc_value> arguments = std::move(intrinsicArguments[&func]);
+                        intrinsicArguments.erase(&func);
+
+                        // intrinsics of a module are registered as `module::name`.
+                        std::string key;
+                        for(const std::string& m : func.modulePath)
+                            key += m + "::";
+                        key += name;
+                        auto decl = inb_impls::INB_IMPLS_MAP.find(key);
                         if (decl == inb_impls::INB_IMPLS_MAP.end())
                         {
-                            err = "Fatal: inbuilt (__cpp__ decl) c++ function mapping for '" + name + "' doesn't exist. This could be due to a mismatch in versions.";
+                            err = "Fatal: inbuilt (__cpp__ decl) c++ function mapping for '" + key + "' doesn't exist. This could be due to a mismatch in versions.";
                             return {};
                         }
-                        decl->second(program, factory, parameters, err);
+                        if (!inb_impls::check(key, decl->second, arguments, err))
+                            return {};
+                        decl->second.impl(program, factory, arguments, err);
                         if (!err.empty())
                             return {}; // todo can printerr here!!!
+                        for(rbc_value& argument : arguments)
+                            if (argument.index() == 1)
+                                std::get<1>(argument)->free();
                     }
                     else
                     {
                         // we do need the parameters at runtime! the function is not inbuilt
+                        factory.disableBuffer();
+                        factory.passMacroArguments(func);
                         factory.addBuffer();
                         factory.invoke(moduleName, func);
                         factory.clearBuffer();
@@ -1510,6 +2810,9 @@ mc_program tomc(rbc_program& program, const std::string& moduleName, std::string
                     while (i + 1 < instructions.size() && instructions.at(i + 1).type == rbc_instruction::POP)
                     {
                         i++;
+                        // parameters in fixed slots are overwritten by the next call instead.
+                        if (!func.recursive)
+                            continue;
                         factory.popParameter();
                         mcprogram.varStackCount--;
                     }
@@ -1520,38 +2823,50 @@ mc_program tomc(rbc_program& program, const std::string& moduleName, std::string
                 {
                     RS_ASSERT_SIZE(size >= 2);
 
-                    // store PUSH generated commands into a buffer so that if an inbuilt function is called,
-                    // we can clear the buffer as the function is handled at compile time.
+                    rbc_constant paramName = std::get<0>(*instruction.parameters.at(1));
+
+                    std::shared_ptr<rbc_function> func = resolvePush(instruction);
+                    if (!func)
+                    {
+                        err = "Function defined in module has caused seg fault. Flag this error on the github, it should not occur.";
+                        break;
+                    }
+                    // inbuilt functions are given their arguments as they are, at compile time.
+                    if (std::find(func->decorators.begin(), func->decorators.end(), rbc_function_decorator::CPP) != func->decorators.end())
+                    {
+                        rbc_value& argument = *instruction.parameters.at(2);
+                        // kept until the call, see callparse.
+                        if (argument.index() == 1)
+                            std::get<1>(argument)->vacant = false;
+                        intrinsicArguments[func.get()].push_back(argument);
+                        break;
+                    }
+                    // store PUSH generated commands into a buffer, written before the call once the arguments are all worked out.
                     if (!factory.usingBuffer())
                     {
                         factory.createBuffer();
                         factory.enableBuffer();
                     }
-
-                    rbc_constant funcName = std::get<0>(*instruction.parameters.at(0));
-                    rbc_constant paramName = std::get<0>(*instruction.parameters.at(1));
-
-                    std::unordered_map<std::string, std::shared_ptr<rbc_function>>::iterator func;
-
-                    if (size == 4)
-                    {
-                        rs_module* fromModule = (rs_module*) std::get<std::shared_ptr<void>>(*instruction.parameters.at(3)).get();
-                        
-                        if(!fromModule)
-                        {
-                            err = "Function defined in module has caused seg fault. Flag this error on the github, it should not occur.";
-                            break;
-                        }
-                        else
-                            func = fromModule->functions.find(funcName.val);
-                    }
-                    else
-                        func = program.functions.find(funcName.val);
                     // TODO: change to param index?
-                    rs_variable* param = func->second->getParameterByName(paramName.val);
+                    rs_variable* param = func->getParameterByName(paramName.val);
                     // TODO: add null checks here
 
+                    if (param->comp_info.macro)
+                    {
+                        factory.macroArgument(*param, *instruction.parameters.at(2));
+                        break;
+                    }
+                    // the caller writes straight into the parameter's slot, only recursive functions need a stack frame.
+                    if (!param->comp_info.slot.empty())
+                    {
+                        factory.setVariableValue(*param, *instruction.parameters.at(2));
+                        break;
+                    }
+                    // the callee's own instructions keep reading the parameter at its place in the callee's frame.
+                    const int index = param->comp_info.varIndex;
+                    param->comp_info.stacked = true;
                     factory.createVariable(*param, *instruction.parameters.at(2));
+                    param->comp_info.varIndex = index;
                     mcprogram.stack.push_back(param);
 
                     break;
@@ -1563,201 +2878,83 @@ mc_program tomc(rbc_program& program, const std::string& moduleName, std::string
                     RS_ASSERT_SIZE(size > 0);
                     const bool invertFlag = instruction.type == rbc_instruction::NIF;
 
-                    if (size == 1)
+                    std::vector<std::shared_ptr<comparison_register>> used;
+                    rbc_condition condition = lowerCondition(instruction, used);
+                    if (!err.empty())
+                        return {};
+
+                    // decided at compile time
+                    if (instruction.type == rbc_instruction::IF && condition.constant != -1)
                     {
-                        // bool convertable if statement
-                        rbc_value& param = *instruction.parameters.at(0);
-                        switch(param.index())
+
+                        const int value = condition.constant;
+
+                        if (value == 0)
                         {
-                            case 0:
+                            // skip instructions contained
+                            while(++i < instructions.size())
                             {
-                                rbc_constant& _const = std::get<0>(param);
-                                if (_const.val_type != token_type::INT_LITERAL)
-                                {
-                                    // todo move error to torbc
-                                    err = std::format("Cannot convert typeid {} to boolean.", static_cast<int>(_const.val_type));
-                                    return {};
-                                }
-                                const int value = std::stoi(_const.val);
-
-                                if (value == 0)
-                                {
-                                    // skip instructions contained
-                                    while(++i < instructions.size())
-                                    {
-                                        auto& inst = instructions.at(i);
-                                        if (inst.type == rbc_instruction::ELSE)
-                                            goto skip;
-                                        if (inst.type == rbc_instruction::ENDIF)
-                                            break;
-                                    }
-
-                                    i++; // skip ENDIF
-                                }
-                                else
-                                {
-                                skip:
-                                    // remove next end if and parse as normal
-                                    size_t c = i;
-                                    while(++c < instructions.size())
-                                    {
-                                        auto& inst = instructions.at(c);
-                                        if(inst.type == rbc_instruction::ENDIF)
-                                        {
-                                            instructions.erase(instructions.begin() + c);
-                                            break;
-                                        }
-                                    }
-                                }
-                                break;
+                                auto& inst = instructions.at(i);
+                                if (inst.type == rbc_instruction::ELSE)
+                                    goto skip;
+                                if (inst.type == rbc_instruction::ENDIF)
+                                    break;
                             }
-                            case 1:
+
+                            i++; // skip ENDIF
+                        }
+                        else
+                        {
+                        skip:
+                            // remove next end if and parse as normal
+                            size_t c = i;
+                            while(++c < instructions.size())
                             {
-                                rbc_register& reg = *std::get<1>(param);
-                                std::shared_ptr<comparison_register> outReg = nullptr;
-                                if (reg.operable)
+                                auto& inst = instructions.at(c);
+                                if(inst.type == rbc_instruction::ENDIF)
                                 {
-                                    // makes reg if needed
-                                    outReg = factory.compareNull(true, MC_OPERABLE_REG(INS_L(STR(reg.id))), !invertFlag);
+                                    instructions.erase(instructions.begin() + c);
+                                    break;
                                 }
-                                else
-                                {
-                                    outReg = factory.compareNull(false, MC_NOPERABLE_REG(reg.id), !invertFlag);
-                                    // see if contents is also not 0
-                                }
-                                mcprogram.blocks.push({0, outReg});
-                                break;
-                            }
-                            case 2:
-                            {
-                                rs_variable& var = *std::get<2>(param);
-                                std::shared_ptr<comparison_register> outReg = factory.compareNull(false, MC_VARIABLE_VALUE(var.comp_info.varIndex), !invertFlag);
-                                
-                                mcprogram.blocks.push({0, outReg});
-                                break;
                             }
-                            default:
-                                ERROR("Cannot compare rbc_value of unimplemented typeid to null. If you see this error, flag an issue.");
                         }
                         break;
                     }
-                    
-                    RS_ASSERT_SIZE(size == 3);
-                    rbc_value& lhs = *instruction.parameters.at(0);
-                    rbc_constant& op = std::get<0>(*instruction.parameters.at(1));
-                    bool eq = op.val == "==";
-                    if (invertFlag) eq = !eq;
+                    if (condition.constant != -1)
+                        condition.subcommands = condition.constant ? "" : MC_FALSE_CONDITION;
 
-                    rbc_value& rhs = *instruction.parameters.at(2);
-
-                    // commutative check, as no values are modified
-                    std::shared_ptr<comparison_register> usedRegister = nullptr;
-                    if (lhs.index() == rhs.index())
+                    if (instruction.type == rbc_instruction::IF && outlineBranch(instructions, i, condition.subcommands))
                     {
-                        switch(lhs.index())
-                        {
-                            case 0:
-                            {
-                                // two constants.
-                                WARN("Comparing two constants is not good practice.");
-                                break;
-                            }
-                            case 1:
-                            {
-                                // two registers
-                                rbc_register& reg  = *std::get<1>(lhs);
-                                rbc_register& reg2 = *std::get<1>(rhs);
-
-                                if ((reg.operable && !reg2.operable) || (!reg.operable && reg2.operable))
-                                {
-                                    // store result in storage and compare
-                                    rbc_register& operable =  reg2.operable ? reg2 : reg;
-                                    rbc_register& noperable = reg2.operable ? reg  : reg2; 
-                                    factory.add( factory.getRegisterValue(noperable).storeResult(PADR(scoreboard) MC_TEMP_SCOREBOARD_STORAGE) );
-
-                                    usedRegister = factory.compare("score", MC_OPERABLE_REG(INS_L(STR(operable.id))), eq, MC_TEMP_SCOREBOARD_STORAGE);
-                                }
-                                // both are either operable or not operable
-                                else if (reg.operable)
-                                    usedRegister = factory.compare("score", MC_OPERABLE_REG(INS_L(STR(reg.id))), eq, MC_OPERABLE_REG(INS_L(STR(reg2.id))));
-                                else // TODO fix NOPERABLE_REG_GET: not raw, has extra commands at start
-                                    usedRegister = factory.compare("data", MC_NOPERABLE_REG_GET(reg.id), eq, MC_NOPERABLE_REG_GET(reg2.id));
-                                break;
-                            }
-                            case 2:
-                            {
-                                rs_variable& var  = *std::get<2>(lhs);
-                                rs_variable& var2 = *std::get<2>(rhs);
-
-                                usedRegister = factory.compare("data", RS_PROGRAM_STORAGE SEP MC_VARIABLE_VALUE(var.comp_info.varIndex), eq,
-                                                        RS_PROGRAM_STORAGE SEP MC_VARIABLE_VALUE(var.comp_info.varIndex));
-
-                                break;
-                            }
-                            default:
-                                WARN("Unimplemented comparison.");
-                        }
+                        for(auto& r : used)
+                            r->free();
+                        break;
                     }
+                    // the condition is stored, as the block could change what it tests.
+                    std::shared_ptr<comparison_register> usedRegister;
+                    if (used.size() == 1 && condition.subcommands == factory.testRegister(*used.at(0)))
+                        usedRegister = used.at(0);
                     else
                     {
-                        {
-                        result_pair<sharedt<rbc_register>, rbc_constant> res = 
-                            commutativeVariantEquals<sharedt<rbc_register>, rbc_constant, rbc_value>(1, lhs, 0, rhs);
-                        if (res)
-                        {
-                            rbc_register& reg = *(*res.i1);
-                            rbc_constant& con =   *res.i2;
-
-                            if (reg.operable)
-                            {
-                                usedRegister = factory.compare("score", MC_OPERABLE_REG(INS_L(STR(reg.id))), eq, con.val, true);
-                            }
-                            else
-                            {
-                                factory.create_and_push(MC_DATA_CMD_ID, MC_TEMP_STORAGE_SET_CONST(con.val));
-                                // TODO: fix to not have leading keywords!
-                                usedRegister = factory.compare("data", MC_NOPERABLE_REG_GET(reg.id), eq, MC_TEMP_STORAGE);
-                            }
-                            goto _end;
-                        }
-                        }
-                        {
-                        result_pair<sharedt<rbc_register>, sharedt<rs_variable>> res = 
-                            commutativeVariantEquals<sharedt<rbc_register>, sharedt<rs_variable>, rbc_value>(1, lhs, 2, rhs);
-
-                        if (res)
-                        {
-                            rbc_register& reg = *(*res.i1);
-                            rs_variable&  var = *(*res.i2);
-
-                            if (reg.operable)
-                                factory.getRegisterValue(reg).storeResult(PADR(storage) MC_TEMP_STORAGE, "int", 1);
-                            else
-                                factory.copyStorage(MC_TEMP_STORAGE, MC_NOPERABLE_REG_GET(reg.id));
-                            usedRegister = factory.compare("data", MC_VARIABLE_VALUE(var.comp_info.varIndex), eq, MC_TEMP_STORAGE);
-                            goto _end;
-                        }
-                        }
-                        {
-                        result_pair<sharedt<rs_variable>, rbc_constant> res = 
-                            commutativeVariantEquals<sharedt<rs_variable>, rbc_constant, rbc_value>(2, lhs, 0, rhs);
-
-                        if (res)
-                        {
-                            rs_variable&  var = *(*res.i1);
-                            rbc_constant& con = *res.i2;
-                            
-                            usedRegister = factory.compare("data", MC_VARIABLE_VALUE(var.comp_info.varIndex), eq, con.val, true);
-                            goto _end;
-                        }
-                        }
+                        usedRegister = factory.getFreeComparisonRegister();
+                        usedRegister->vacant = false;
+                        usedRegister->operation = comparison_operation_type::EQ;
+                        if (condition.subcommands.empty())
+                            factory.create_and_push(MC_SCOREBOARD_CMD_ID, MC_COMPARE_REG_SET(usedRegister->id, "1"));
+                        else
+                            factory.create_and_push(MC_EXEC_CMD_ID, "store success score " + MC_COMPARE_REG_FULL(usedRegister->id) + SEP + condition.subcommands);
+                        for(auto& r : used)
+                            r->free();
                     }
-                _end:
+                    if (invertFlag)
+                        usedRegister->operation = usedRegister->operation == comparison_operation_type::EQ ? comparison_operation_type::NEQ : comparison_operation_type::EQ;
                     mcprogram.blocks.push({0, usedRegister});
+                    factory.enterScope();
                     break;
                 }
                 case rbc_instruction::ELSE:
                 {
+                    // the if block's variables are removed while its condition still applies.
+                    factory.leaveScope().enterScope();
                     // pop the if off the blocks.
                     auto& block = mcprogram.blocks.top();
                     
@@ -1770,6 +2967,7 @@ mc_program tomc(rbc_program& program, const std::string& moduleName, std::string
                 }
                 case rbc_instruction::ELIF:
                 {   
+                    factory.leaveScope().enterScope();
                     auto& block = mcprogram.blocks.top();
                     
                     auto reg = block.second;
@@ -1780,16 +2978,120 @@ mc_program tomc(rbc_program& program, const std::string& moduleName, std::string
                 }
                 case rbc_instruction::ENDIF:
                 {
+                    factory.leaveScope();
                     auto& block = mcprogram.blocks.top();
                     block.second->vacant = true;
 
                     mcprogram.blocks.pop();
                     
-                    // we have an elif
-                    if (mcprogram.blocks.size() > 0 && mcprogram.blocks.top().first == 2)
+                    // we have an elif chain, ended by a single ENDIF
+                    while (mcprogram.blocks.size() > 0 && mcprogram.blocks.top().first == 2)
+                    {
+                        mcprogram.blocks.top().second->free();
                         mcprogram.blocks.pop();
+                        factory.leaveScope();
+                    }
+                    break;
+                }
+                // converted with the block they end, by AS and FOR.
+                case rbc_instruction::ENDAS:
+                case rbc_instruction::ENDFOR:
+                    break;
+                case rbc_instruction::AS:
+                {
+                    RS_ASSERT_SIZE(size == 2);
+                    // the block is run by its own function, once per entity.
+                    size_t depth = 0, end = 0;
+                    for(size_t c = i + 1; c < instructions.size() && !end; c++)
+                    {
+                        switch(instructions.at(c).type)
+                        {
+                            case rbc_instruction::AS:
+                                depth++;
+                                break;
+                            case rbc_instruction::ENDAS:
+                                if (depth == 0)
+                                    end = c;
+                                else
+                                    depth--;
+                                break;
+                            // it would only leave the block's function, for the current entity.
+                            case rbc_instruction::RET:
+                                err = "Can't return from inside an as/at block.";
+                                return {};
+                            default:
+                                break;
+                        }
+                    }
+                    RS_ASSERT_SIZE(end);
+                    const std::string& selector = std::get<rbc_constant>(*instruction.parameters.at(0)).val;
+                    const bool at = std::get<rbc_constant>(*instruction.parameters.at(1)).val == "1";
+                    const std::string call = addOutlined(parseDetached(instructions, i + 1, end, true));
+                    factory.create_and_push(MC_EXEC_CMD_ID, MC_EXECUTE_AS(selector) + (at ? MC_AT_SELF : "") + " run function " + call);
+                    i = end;
+                    break;
+                }
+                case rbc_instruction::FOR:
+                {
+                    RS_ASSERT_SIZE(size >= 2);
+                    size_t depth = 0, end = 0;
+                    for(size_t c = i + 1; c < instructions.size() && !end; c++)
+                    {
+                        switch(instructions.at(c).type)
+                        {
+                            case rbc_instruction::FOR:
+                                depth++;
+                                break;
+                            case rbc_instruction::ENDFOR:
+                                if (depth == 0)
+                                    end = c;
+                                else
+                                    depth--;
+                                break;
+                            // it would only leave the loop's function.
+                            case rbc_instruction::RET:
+                                err = "Can't return from inside a for loop.";
+                                return {};
+                            default:
+                                break;
+                        }
+                    }
+                    RS_ASSERT_SIZE(end);
+                    rs_variable& source = *std::get<sharedt<rs_variable>>(*instruction.parameters.at(0));
+                    rs_variable& item   = *std::get<sharedt<rs_variable>>(*instruction.parameters.at(1));
+                    mccmdlist body = parseDetached(instructions, i + 1, end, true);
+                    if (size > 2)
+                    {
+                        // the members are known, the block is called once for each of them.
+                        const std::string call = addOutlined(body);
+                        factory.forObject(source, item, *std::get<sharedt<rs_object>>(*instruction.parameters.at(2)), call);
+                    }
+                    else
+                    {
+                        // the block's function calls itself while the copy isn't empty.
+                        body.push_back(factory.removeFirst(source).addroot());
+                        const std::string call = addOutlined(body);
+                        mcprogram.functions.back().commands.push_back(factory.whileNotEmpty(source, call).addroot());
+                        factory.add(factory.whileNotEmpty(source, call));
+                    }
+                    i = end;
+                    break;
+                }
+                case rbc_instruction::INDEX:
+                {
+                    RS_ASSERT_SIZE(size == 2);
+                    // the index is only known at runtime, the element is copied by a macro.
+                    RS_ASSERTC(factory.supports(mc_feature::MACROS), "A list index known at runtime needs function macros, which the target version doesn't support.");
+                    rs_variable& var = *std::get<sharedt<rs_variable>>(*instruction.parameters.at(0));
+                    factory.listElement(var, std::get<rbc_constant>(*instruction.parameters.at(1)).val == "1");
                     break;
                 }
+                case rbc_instruction::INC:
+                    factory.enterScope();
+                    break;
+                case rbc_instruction::DEC:
+                    factory.leaveScope();
+                    break;
                 case rbc_instruction::RET:
                 {
                     // TODO
@@ -1815,7 +3117,7 @@ mc_program tomc(rbc_program& program, const std::string& moduleName, std::string
                             {
                                 rbc_register& reg = *std::get<1>(val);
 
-                                factory.getRegisterValue(reg).storeResult(PADR(storage) RS_PROGRAM_STORAGE SEP RS_PROGRAM_RETURN_REGISTER);
+                                factory.add(factory.storeRegister(reg, RS_PROGRAM_RETURN_REGISTER, reg.scale != 1));
 
                                 if (reg.operable)
                                 {
@@ -1834,8 +3136,17 @@ mc_program tomc(rbc_program& program, const std::string& moduleName, std::string
                             {
                                 rs_variable& var = *std::get<2>(val);
 
-                                factory.copyStorage(RS_PROGRAM_STORAGE SEP RS_PROGRAM_RETURN_REGISTER, MC_VARIABLE_VALUE_FULL(var.comp_info.varIndex));
-                                factory.copyStorage(RS_PROGRAM_STORAGE SEP RS_PROGRAM_RETURN_TYPE_REGISTER, MC_VARIABLE_TYPE_FULL(var.comp_info.varIndex));
+                                if (var.comp_info.scoreboard)
+                                    factory.add(factory.getVariableValue(var).storeResult(PADR(storage) RS_PROGRAM_STORAGE SEP RS_PROGRAM_RETURN_REGISTER, "int", 1));
+                                else
+                                    factory.copyStorage(RS_PROGRAM_RETURN_REGISTER, factory.variablePath(var));
+
+                                const std::string typePath = factory.variableTypePath(var);
+                                // statically typed (members, parameter slots)
+                                if (typePath.empty())
+                                    factory.create_and_push(MC_DATA_CMD_ID, MC_DATA(modify storage, RS_PROGRAM_RETURN_TYPE_REGISTER) PAD(set value) INS_L(STR(var.type_info.type_id)));
+                                else
+                                    factory.copyStorage(RS_PROGRAM_RETURN_TYPE_REGISTER, typePath);
                                 break;
                             }
                             default:
@@ -1853,10 +3164,22 @@ mc_program tomc(rbc_program& program, const std::string& moduleName, std::string
 
                     rs_variable& var = *std::get<2>(*instruction.parameters.at(0));
 
-                    factory.copyStorage(MC_VARIABLE_VALUE(var.comp_info.varIndex), RS_PROGRAM_RETURN_REGISTER);
-                    factory.copyStorage(MC_VARIABLE_TYPE(var.comp_info.varIndex) , RS_PROGRAM_RETURN_TYPE_REGISTER);
+                    factory.storeReturn(var);
+                    break;
+                }
+                case rbc_instruction::CAST:
+                {
+                    RS_ASSERT_SIZE(size == 2);
+
+                    rs_variable&  var      = *std::get<2>(*instruction.parameters.at(0));
+                    rbc_constant& selector = std::get<0>(*instruction.parameters.at(1));
+
+                    factory.project(var, selector.val);
                     break;
                 }
+                // async functions are split at their yields before they're converted.
+                case rbc_instruction::YIELD:
+                    break;
             }
         }
         mccmdlist list = factory.package();
@@ -1865,8 +3188,6 @@ mc_program tomc(rbc_program& program, const std::string& moduleName, std::string
     };
     
     // try{
-        mcprogram.globalFunction.commands = parseFunction(program.globalFunction.instructions);
-
         std::vector<std::shared_ptr<rbc_function>> allFunctions;
 
 
@@ -1910,6 +3231,118 @@ mc_program tomc(rbc_program& program, const std::string& moduleName, std::string
             }
         }
 
+        // a function is recursive if it can reach itself through its calls.
+        std::function<bool(rbc_function*, rbc_function*, std::vector<rbc_function*>&)> reaches =
+            [&](rbc_function* from, rbc_function* to, std::vector<rbc_function*>& visited) -> bool
+        {
+            for(auto& instruction : from->instructions)
+            {
+                if (instruction.type != rbc_instruction::CALL)
+                    continue;
+                std::shared_ptr<rbc_function> callee = resolveCall(instruction);
+                if (!callee)
+                    continue;
+                if (callee.get() == to)
+                    return true;
+                if (std::find(visited.begin(), visited.end(), callee.get()) != visited.end())
+                    continue;
+                visited.push_back(callee.get());
+                if (reaches(callee.get(), to, visited))
+                    return true;
+            }
+            return false;
+        };
+        for(auto& function : allFunctions)
+        {
+            std::vector<rbc_function*> visited;
+            function->recursive = reaches(function.get(), function.get(), visited);
+
+            auto& decorators = function->decorators;
+            if (std::find(decorators.begin(), decorators.end(), rbc_function_decorator::ASYNC) != decorators.end())
+            {
+                // every invocation would share the frame of the running one.
+                if (function->recursive)
+                {
+                    err = "Async function '" + function->name + "' can't be recursive.";
+                    return mcprogram;
+                }
+                function->asyncId = mcprogram.asyncFunctions++;
+                function->macroArguments = "";
+                for(size_t i = 0; i < function->parameters.size(); i++)
+                    factory.allocateFrameSlot(*function, *function->localVariables.at(function->parameters.at(i)).first, i);
+                continue;
+            }
+            if (function->recursive
+            ||  std::find(decorators.begin(), decorators.end(), rbc_function_decorator::CPP)    != decorators.end()
+            ||  std::find(decorators.begin(), decorators.end(), rbc_function_decorator::EXTERN) != decorators.end())
+                continue;
+
+            // parameters passed on to an inbuilt function as a selector are used inside a command.
+            uint commandUses = 0;
+            for(auto& instruction : function->instructions)
+            {
+                if (instruction.type != rbc_instruction::PUSH || instruction.parameters.at(2)->index() != 2)
+                    continue;
+                std::shared_ptr<rbc_function> callee = resolvePush(instruction);
+                if (!callee || std::find(callee->decorators.begin(), callee->decorators.end(), rbc_function_decorator::CPP) == callee->decorators.end())
+                    continue;
+                rs_variable* target = callee->getParameterByName(std::get<rbc_constant>(*instruction.parameters.at(1)).val);
+                rs_variable* value  = std::get<2>(*instruction.parameters.at(2)).get();
+                if (target && target->type_info.type_id == RS_SELECTOR_KW_ID && function->getParameterByName(value->name) == value)
+                    commandUses++;
+            }
+            const bool macro = factory.supports(mc_feature::MACROS) && factory.prefersMacroCall(commandUses);
+            function->macroArguments = macro ? MC_MACRO_ARGUMENTS(mcprogram.macroFunctions++) : "";
+
+            for(const std::string& param : function->parameters)
+            {
+                rs_variable& var = *function->localVariables.at(param).first;
+                factory.allocateSlot(var);
+                // the rest is passed in the argument compound, so constants are written in one command.
+                if (macro && !var.comp_info.scoreboard)
+                    factory.allocateMacroSlot(*function, var);
+            }
+        }
+
+        // parsing edits the instructions it's given, the program can be converted again for other targets.
+        std::vector<rbc_command> globalInstructions = copyInstructions(program.globalFunction.instructions);
+
+        // top level variables are created once, when the pack loads, so running the program again doesn't create them again.
+        int depth = 0;
+        for(auto& instruction : globalInstructions)
+        {
+            switch(instruction.type)
+            {
+                case rbc_instruction::IF:
+                case rbc_instruction::NIF:
+                case rbc_instruction::INC:
+                case rbc_instruction::AS:
+                case rbc_instruction::FOR:
+                    depth++;
+                    break;
+                case rbc_instruction::ENDIF:
+                case rbc_instruction::DEC:
+                case rbc_instruction::ENDAS:
+                case rbc_instruction::ENDFOR:
+                    depth--;
+                    break;
+                case rbc_instruction::CREATE:
+                    if (depth == 0)
+                        factory.loadVariable(*std::get<sharedt<rs_variable>>(*instruction.parameters.at(0)),
+                                             instruction.parameters.size() > 1 ? instruction.parameters.at(1).get() : nullptr);
+                    break;
+                default:
+                    break;
+            }
+        }
+        cacheSelectors(globalInstructions, true);
+        mcprogram.globalFunction.commands = parseFunction(globalInstructions);
+        factory.uncacheSelectors();
+        factory.countStorage();
+        mccmdlist counted = factory.package();
+        factory.clear();
+        mcprogram.globalFunction.commands.insert(mcprogram.globalFunction.commands.end(), counted.begin(), counted.end());
+
         for(auto& function : allFunctions)
         {
             auto& decorators = function->decorators;
@@ -1919,21 +3352,126 @@ mc_program tomc(rbc_program& program, const std::string& moduleName, std::string
                 std::find(decorators.begin(), decorators.end(), rbc_function_decorator::EXTERN) == decorators.end()
             ) // not inbuilt function 
             {
-                mc_function f{function->name,
-                              parseFunction(function->instructions),
-                              function->modulePath};
-                f.parentalHashStr = function->getParentHashStr();
-                mcprogram.functions.push_back(f);
+                owner = function.get();
+                std::vector<rbc_command> instructions = copyInstructions(function->instructions);
+
+                // every call starts a frame: parameters of recursive functions were pushed by the caller, the
+                // function's flat slots follow the ones taken by everything converted before it.
+                mcprogram.varStackCount = 0;
+                mcprogram.heapRefs.clear();
+                if (function->recursive)
+                    for(const std::string& param : function->parameters)
+                    {
+                        rs_variable& var = *function->localVariables.at(param).first;
+                        var.comp_info.stacked = true;
+                        var.comp_info.varIndex = mcprogram.varStackCount++;
+                    }
+                mcprogram.frameBase = mcprogram.varStackCount;
+                mcprogram.recursiveFrame = function->recursive;
+                // the frame of an async function has its own keys, after the parameters.
+                const bool async = function->asyncId != -1;
+                mcprogram.asyncFrame = async ? MC_ASYNC_FRAME(function->asyncId) : "";
+                mcprogram.flatSlots = async ? function->parameters.size() : mcprogram.flatSlotsEnd;
+
+                // the tags would outlive a part of an async function, and be removed by a recursive call.
+                cacheSelectors(instructions, !async && !function->recursive);
+
+                // an async function is split at its yields, every part scheduling the next one.
+                std::vector<std::vector<rbc_command>> parts(1);
+                for(auto& instruction : instructions)
+                {
+                    if (instruction.type == rbc_instruction::YIELD)
+                        parts.emplace_back();
+                    else
+                        parts.back().push_back(std::move(instruction));
+                }
+                auto partName = [&](size_t i) { return i ? function->name + "_s" + STR(i) : function->name; };
+                for(size_t i = 0; i < parts.size(); i++)
+                {
+                    std::vector<rbc_command>& part = parts.at(i);
+                    if (i)
+                        factory.resumeFrame(function->asyncId);
+                    mccmdlist commands = i ? factory.package() : mccmdlist{};
+                    factory.clear();
+
+                    mccmdlist body = parseFunction(part);
+                    commands.insert(commands.end(), body.begin(), body.end());
+                    if (part.empty() || part.back().type != rbc_instruction::RET)
+                    {
+                        if (i + 1 < parts.size())
+                            factory.suspendFrame(function->asyncId, factory.functionPath(moduleName, function->modulePath, function->getParentHashStr(), partName(i + 1)));
+                        else
+                            factory.leaveFrame();
+                        mccmdlist exit = factory.package();
+                        factory.clear();
+                        commands.insert(commands.end(), exit.begin(), exit.end());
+                    }
+                    mc_function f{partName(i),
+                                  commands,
+                                  function->modulePath};
+                    f.parentalHashStr = function->getParentHashStr();
+                    mcprogram.functions.push_back(f);
+                }
+                mcprogram.asyncFrame = "";
+                if (std::find(decorators.begin(), decorators.end(), rbc_function_decorator::TICK) != decorators.end())
+                {
+                    if (!function->parameters.empty())
+                    {
+                        err = "Tick function '" + function->name + "' can't have parameters, it's called by the game.";
+                        return mcprogram;
+                    }
+                    mcprogram.tickFunctions.push_back(factory.functionPath(moduleName, function->modulePath, function->getParentHashStr(), function->name));
+                }
+            }
+        }
+        // jobs run from the tick tag until the budget is used up, one function taking the next job and calling itself
+        // while there is budget left. a job costs its own commands and the scheduler's, not the functions it calls.
+        if (!mcprogram.jobs.empty())
+        {
+            const uint budget = RS_CONFIG.exists("scheduler_budget") ? RS_CONFIG.get<int>("scheduler_budget") : RS_SCHEDULER_BUDGET;
+            const std::string run = factory.functionPath(moduleName, {}, "", RS_SCHEDULER_FUNCTION_NAME "_run");
+            const std::string pending = "if data storage " RS_PROGRAM_STORAGE SEP MC_NEXT_JOB " run function " + run;
+
+            mccmdlist starts;
+            for(uint id = 0; id < mcprogram.jobs.size(); id++)
+            {
+                rbc_function& job = *mcprogram.jobs.at(id);
+                uint cost = mcprogram.jobs.size() + 6;
+                for(auto& f : mcprogram.functions)
+                    if (f.name == job.name && f.modulePath == job.modulePath && f.parentalHashStr == job.getParentHashStr())
+                        cost += f.commands.size();
+
+                factory.startJob(moduleName, job, cost);
+                mcprogram.functions.push_back(mc_function{RS_SCHEDULER_FUNCTION_NAME "_j" + STR(id), factory.package(), {}});
+                factory.clear();
+                starts.push_back(mc_command{false, MC_EXEC_CMD_ID, "if score " MC_SCHEDULER_COUNTER("job") " matches " + STR(id) +
+                                                                   " run function " + factory.functionPath(moduleName, {}, "", mcprogram.functions.back().name)});
             }
+            mc_command next = mc_command(false, MC_DATA_CMD_ID, MC_DATA(get storage, MC_NEXT_JOB ".j")).storeResult(PADR(score) MC_SCHEDULER_COUNTER("job"));
+            factory.add(next);
+            for(auto& start : starts)
+                factory.add(start);
+            factory.create_and_push(MC_EXEC_CMD_ID, "if score " MC_SCHEDULER_COUNTER("budget") " matches 1.. " + pending);
+            mcprogram.functions.push_back(mc_function{RS_SCHEDULER_FUNCTION_NAME "_run", factory.package(), {}});
+            factory.clear();
+
+            factory.create_and_push(MC_SCOREBOARD_CMD_ID, PADR(players set) MC_SCHEDULER_COUNTER("budget") SEP + STR(budget));
+            factory.create_and_push(MC_EXEC_CMD_ID, pending);
+            mcprogram.functions.push_back(mc_function{RS_SCHEDULER_FUNCTION_NAME, factory.package(), {}});
+            factory.clear();
+            mcprogram.tickFunctions.push_back(factory.functionPath(moduleName, {}, "", RS_SCHEDULER_FUNCTION_NAME));
         }
     // } catch (std::exception& e)
     // {
     //     err = std::string("Internal error: ") + e.what();
     //     return mcprogram;
     // }
+    factory.mathLibrary(moduleName);
+    factory.listLibrary();
+    factory.mapLibrary();
+    factory.heapLibrary(moduleName);
     factory.initProgram();
-    mccmdlist init = factory.package();
-    mcprogram.globalFunction.commands.insert(mcprogram.globalFunction.commands.begin(), init.begin(), init.end());
+    mcprogram.initFunction = mc_function{RS_INIT_FUNCTION_NAME, factory.package(), {}};
 
     return mcprogram;
 }
@@ -1943,18 +3481,63 @@ namespace conversion
     {
         // ROOT
         _nonConditionalFlag = true;
-        create_and_push(MC_DATA_CMD_ID, MC_DATA(merge storage, RS_PROGRAM_DATA_DEFAULT));
+        auto join = [](const std::vector<std::string>& values)
+        {
+            std::string joined;
+            for(size_t i = 0; i < values.size(); i++)
+                joined += (i ? "," : "") + values.at(i);
+            return joined;
+        };
+        std::string slots;
+        if (storageLayout() == mc_storage_layout::FLAT)
+            slots = ", \"" RS_PROGRAM_SLOTS "\":{" + join(context.loadedSlots) + "}, \"" RS_PROGRAM_SLOT_TYPES "\":{" + join(context.loadedSlotTypes) + "}";
+        create_and_push(MC_DATA_CMD_ID, MC_DATA(merge storage, RS_PROGRAM_DATA_DEFAULT(join(context.loadedVariables), slots)));
 
         // OPERABLE REGISTERS
         // todo fix. min reg count isnt calculated correctly.
-        create_and_push(MC_SCOREBOARD_CMD_ID, "objectives add temp dummy \"temp\"");
-
         mccmdlist programInit;
 
-        for(size_t i = 0; i < context.comparisonRegisters.size(); i++)
-            programInit.push_back(mc_command{false, MC_SCOREBOARD_CMD_ID, MC_CREATE_COMPARISON_REGISTER(i, "dummy")});
-        for(size_t i = 0; i < rbc_compiler.registers.size(); i++)
-            programInit.push_back(mc_command{false, MC_SCOREBOARD_CMD_ID, MC_CREATE_OPERABLE_REG(i, "dummy")});
+        // every register shares one objective, new registers are only new fake players.
+        if (registerLayout() == mc_register_layout::PLAYERS)
+            programInit.push_back(mc_command{false, MC_SCOREBOARD_CMD_ID, MC_CREATE_REGISTER_OBJ});
+        else
+        {
+            create_and_push(MC_SCOREBOARD_CMD_ID, "objectives add temp dummy \"temp\"");
+            for(size_t i = 0; i < context.comparisonRegisters.size(); i++)
+                programInit.push_back(mc_command{false, MC_SCOREBOARD_CMD_ID, MC_CREATE_COMPARISON_REGISTER(i, "dummy")});
+            for(size_t i = 0; i < rbc_compiler.registers.size(); i++)
+                programInit.push_back(mc_command{false, MC_SCOREBOARD_CMD_ID, MC_CREATE_OPERABLE_REG(i, "dummy")});
+        }
+        if (context.scoreboardSlots)
+            programInit.push_back(mc_command{false, MC_SCOREBOARD_CMD_ID, MC_CREATE_PARAMETER_OBJ});
+        if (!context.constants.empty())
+            programInit.push_back(mc_command{false, MC_SCOREBOARD_CMD_ID, MC_CREATE_CONSTANT_OBJ});
+        if (RS_CONFIG.exists("debug") && RS_CONFIG.get<std::string>("debug") == "storage")
+            programInit.push_back(mc_command{false, MC_SCOREBOARD_CMD_ID, MC_CREATE_DEBUG_OBJ});
+        if (!context.jobs.empty())
+            programInit.push_back(mc_command{false, MC_SCOREBOARD_CMD_ID, MC_CREATE_SCHEDULER_OBJ});
+        if (!context.mathFunctions.empty())
+            programInit.push_back(mc_command{false, MC_SCOREBOARD_CMD_ID, MC_CREATE_MATH_OBJ});
+        // an objective for each member of the scoreboard objects, in the order of their names.
+        std::set<std::string> fields;
+        for(auto& [name, type] : rbc_compiler.objectTypes)
+            if (type->scoreboard)
+                for(auto& [member, _] : type->members)
+                    fields.insert(MC_FIELD_OBJECTIVE(name, member));
+        for(const std::string& objective : fields)
+            programInit.push_back(mc_command{false, MC_SCOREBOARD_CMD_ID, MC_CREATE_FIELD_OBJ(objective)});
+        if (!context.heapFunctions.empty() || context.heapHandles)
+            programInit.push_back(mc_command{false, MC_SCOREBOARD_CMD_ID, MC_CREATE_HEAP_OBJ});
+        // the tables are written once, the functions read them with a macro index.
+        for(const std::string& table : context.mathTables)
+        {
+            std::string values;
+            for(int value : mc_math_table(table))
+                values += (values.empty() ? "" : ",") + STR(value);
+            programInit.push_back(mc_command{false, MC_DATA_CMD_ID, MC_DATA(modify storage, MC_MATH_TABLE(table)) + " set value [" + values + "]"});
+        }
+        for(int value : context.constants)
+            programInit.push_back(mc_command{false, MC_SCOREBOARD_CMD_ID, MC_CONSTANT_SET(STR(value))});
 
         commands.insert(commands.begin(), programInit.begin(), programInit.end());
 
@@ -1962,61 +3545,574 @@ namespace conversion
     }
     CommandFactory::_This CommandFactory::Return           (bool val)
     {
+        leaveFrame();
         create_and_push(MC_RETURN_CMD_ID, val ? "1" : "0");
         return THIS;
     }
 
+    CommandFactory::_This CommandFactory::project          (rs_variable& var, const std::string& selector)
+    {
+        rs_object& type = *var.fromObject;
+        const std::string path = variablePath(var);
+        const std::string entity = MC_ENTITY(selector);
+
+        create_and_push(MC_DATA_CMD_ID, MC_DATA(modify storage, INS(path)) PAD(set value) "{}");
+
+        // only members read after the cast are copied, copying entity NBT is slow.
+        for(const std::string& name : var.comp_info.projection)
+        {
+            auto& member = type.members.at(name);
+            std::string def;
+            if (member.first.value && member.first.value->operation.isSingular())
+            {
+                rbc_constant c(std::get<token>(*member.first.value->operation.left).type,
+                               std::get<token>(*member.first.value->operation.left).repr);
+                c.quoteIfStr();
+                def = c.val;
+            }
+            // not part of the entity NBT, only its default (if it has one) is kept.
+            if (member.second == rs_object_member_decorator::SEPERATE)
+            {
+                if (!def.empty())
+                    create_and_push(MC_DATA_CMD_ID, MC_DATA(modify storage, INS(path + '.' + name)) PAD(set value) INS_L(def));
+                continue;
+            }
+            if (!def.empty())
+                create_and_push(MC_DATA_CMD_ID, MC_DATA(modify storage, INS(path + '.' + name)) PAD(set value) INS_L(def));
+            create_and_push(MC_DATA_CMD_ID, MC_DATA(modify storage, INS(path + '.' + name)) PADL(set from) SEP INS(entity) SEP INS_L(name));
+        }
+        // the cast is null if a required member is missing, checking if it exists does not copy it.
+        for(auto& member : type.members)
+        {
+            if (member.second.second == rs_object_member_decorator::REQUIRED)
+                create_and_push(MC_EXEC_CMD_ID, "unless data " + entity + ' ' + member.first + PADL(run) SEP MC_DATA(data remove storage, INS_L(path)));
+        }
+        return THIS;
+    }
     CommandFactory::_This CommandFactory::pushParameter    (const std::string& name, rbc_value& val)
     {
         switch(val.index())
         {
-            case 0:
-            {
-                rbc_constant& c = std::get<rbc_constant>(val);
-                c.quoteIfStr();
-                create_and_push(MC_DATA_CMD_ID, MC_STACK_PUSH_CONST(c.val));
-                break;
-            }
-            case 1:
+            case 0:
+            {
+                rbc_constant& c = std::get<rbc_constant>(val);
+                c.quoteIfStr();
+                create_and_push(MC_DATA_CMD_ID, MC_STACK_PUSH_CONST(c.val));
+                break;
+            }
+            case 1:
+            {
+                rbc_register& reg = *std::get<sharedt<rbc_register>>(val);
+                add(getRegisterValue(reg).storeResult(
+                    PADR(storage) RS_PROGRAM_DATA SEP RS_PROGRAM_STACK
+                ));
+                break;
+            }
+            case 2:
+            {
+                rs_variable& var = *std::get<sharedt<rs_variable>>(val);
+                appendStorage(RS_PROGRAM_STORAGE SEP RS_PROGRAM_STACK, variablePath(var));
+                break;
+            }
+        }
+        return THIS;
+    }
+    CommandFactory::_This CommandFactory::invoke           (const std::string& module, rbc_function& func)
+    {
+        // TODO: NAMESPACES
+
+        const std::string with = func.macroArguments.empty() ? "" : MC_FUNCTION_WITH(func.macroArguments);
+
+        create_and_push(MC_FUNCTION_CMD_ID, functionPath(module, func.modulePath, func.getParentHashStr(), func.name) + with);
+        return THIS;
+    }
+    std::string           CommandFactory::functionPath     (const std::string& module, const std::vector<std::string>& modulePath,
+                                                            const std::string& parentHashStr, const std::string& name)
+    {
+        std::string path = module + ':';
+        for(const std::string& s : modulePath)
+            path += s + '/';
+        if (!parentHashStr.empty())
+            path += parentHashStr + '_';
+        return path + name;
+    }
+    CommandFactory::_This CommandFactory::allocateMacroSlot(rbc_function& func, rs_variable& param)
+    {
+        param.comp_info.macro = true;
+        param.comp_info.slot  = func.macroArguments + '.' + param.name;
+        return THIS;
+    }
+    // parameters of an async function are written by the caller straight into the frame, taking its first keys.
+    CommandFactory::_This CommandFactory::allocateFrameSlot(rbc_function& func, rs_variable& param, uint id)
+    {
+        param.comp_info.scoreboard = false;
+        param.comp_info.macro = false;
+        param.comp_info.slot = MC_ASYNC_FRAME(func.asyncId) + '.' + mc_slot_name(id);
+        return THIS;
+    }
+    // the frame waits in the queue until the next part of the function runs. every part is scheduled one tick
+    // after the frame is queued, so they run in the order of the queue.
+    CommandFactory::_This CommandFactory::suspendFrame     (uint asyncId, const std::string& next)
+    {
+        create_and_push(MC_DATA_CMD_ID, MC_DATA(modify storage, MC_ASYNC_QUEUE(asyncId))
+                                            + SEP
+                                        MC_DATA(append from storage, MC_ASYNC_FRAME(asyncId)));
+        create_and_push(MC_SCHEDULE_CMD_ID, MC_SCHEDULE_NEXT_TICK(next));
+        return THIS;
+    }
+    CommandFactory::_This CommandFactory::resumeFrame      (uint asyncId)
+    {
+        copyStorage(MC_ASYNC_FRAME(asyncId), MC_ASYNC_QUEUE(asyncId) + "[0]");
+        create_and_push(MC_DATA_CMD_ID, MC_DATA(remove storage, MC_ASYNC_QUEUE(asyncId)) + "[0]");
+        return THIS;
+    }
+    // appends a job of the function to the queue, with the argument its parameter is given when it runs.
+    CommandFactory::_This CommandFactory::enqueue          (rbc_function& func, rbc_value& arg)
+    {
+        auto found = std::find(context.jobs.begin(), context.jobs.end(), &func);
+        const uint id = found - context.jobs.begin();
+        if (found == context.jobs.end())
+            context.jobs.push_back(&func);
+
+        switch(arg.index())
+        {
+            case 0:
+            {
+                rbc_constant& c = std::get<0>(arg);
+                const bool quote = c.val_type == token_type::STRING_LITERAL || c.val_type == token_type::SELECTOR_LITERAL;
+                create_and_push(MC_DATA_CMD_ID, MC_DATA(modify storage, RS_PROGRAM_JOBS) PAD(append value) MC_JOB_JSON_VAL(id, quote ? c.quoted() : c.val));
+                break;
+            }
+            case 1:
+            {
+                create_and_push(MC_DATA_CMD_ID, MC_DATA(modify storage, RS_PROGRAM_JOBS) PAD(append value) MC_JOB_JSON(id));
+                add( getRegisterValue(*std::get<1>(arg)).storeResult(PADR(storage) RS_PROGRAM_STORAGE SEP MC_LAST_JOB ".a", "int", 1) );
+                break;
+            }
+            case 2:
+            {
+                rs_variable& var = *std::get<2>(arg);
+                create_and_push(MC_DATA_CMD_ID, MC_DATA(modify storage, RS_PROGRAM_JOBS) PAD(append value) MC_JOB_JSON(id));
+                if (var.comp_info.scoreboard)
+                    add( getVariableValue(var).storeResult(PADR(storage) RS_PROGRAM_STORAGE SEP MC_LAST_JOB ".a", "int", 1) );
+                else
+                    copyStorage(MC_LAST_JOB ".a", variablePath(var));
+                break;
+            }
+            default:
+                WARN("Unsupported job argument, the job runs without it.");
+                create_and_push(MC_DATA_CMD_ID, MC_DATA(modify storage, RS_PROGRAM_JOBS) PAD(append value) MC_JOB_JSON(id));
+                break;
+        }
+        return THIS;
+    }
+    // takes the first job off the queue, charging its cost to the budget before it runs (so it can queue more work).
+    CommandFactory::_This CommandFactory::startJob         (const std::string& module, rbc_function& func, uint cost)
+    {
+        rs_variable& param = *func.localVariables.at(func.parameters.at(0)).first;
+        if (param.comp_info.scoreboard)
+            add( mc_command(false, MC_DATA_CMD_ID, MC_DATA(get storage, MC_NEXT_JOB ".a")).storeResult(PADR(score) INS_L(variablePath(param))) );
+        else
+            copyStorage(variablePath(param), MC_NEXT_JOB ".a");
+        create_and_push(MC_DATA_CMD_ID, MC_DATA(remove storage, MC_NEXT_JOB));
+        create_and_push(MC_SCOREBOARD_CMD_ID, PADR(players remove) MC_SCHEDULER_COUNTER("budget") SEP INS_L(STR(cost)));
+        return invoke(module, func);
+    }
+#pragma region math
+    // cos is worked out by sin, the other functions stand on their own.
+    std::string           CommandFactory::useMath          (const std::string& name)
+    {
+        context.mathFunctions.insert(name);
+        if (name == "cos")
+            context.mathFunctions.insert("sin");
+        return functionPath(context.module, {RS_MATH_DIRECTORY}, "", name);
+    }
+    // every function reads its inputs from the math objective and returns its result, tables are read two entries at
+    // a time and interpolated, so each one runs a fixed number of commands.
+    CommandFactory::_This CommandFactory::mathLibrary      (const std::string& module)
+    {
+        auto path = [&](const std::string& name) { return functionPath(module, {RS_MATH_DIRECTORY}, "", name); };
+        auto emit = [&](const std::string& name)
+        {
+            context.functions.push_back(mc_function{name, package(), {RS_MATH_DIRECTORY}});
+            clear();
+        };
+        auto push = [&](mc_command cmd) { add(cmd); };
+        auto op = [&](const std::string& lhs, const std::string& operation, const std::string& rhs)
+        {
+            create_and_push(MC_SCOREBOARD_CMD_ID, PADR(players operation) + lhs + SEP + operation + SEP + rhs);
+        };
+        auto opConst = [&](const std::string& lhs, const std::string& operation, int value)
+        {
+            context.constants.insert(value);
+            op(lhs, operation, MC_CONSTANT(STR(value)));
+        };
+        auto returnScore = [&](const std::string& score)
+        {
+            create_and_push(MC_RETURN_CMD_ID, PADR(run scoreboard players get) + score);
+        };
+        const std::string x = MC_MATH_SCORE("x"), y = MC_MATH_SCORE("y"), e = MC_MATH_SCORE("e"), i = MC_MATH_SCORE("i"),
+                          a = MC_MATH_SCORE("a"), b = MC_MATH_SCORE("b"), n = MC_MATH_SCORE("n"), d = MC_MATH_SCORE("d");
+        // a = table[i] + (table[i + 1] - table[i]) * fraction / denominator
+        auto lerp = [&](const std::string& table, const std::string& fraction, int denominator)
+        {
+            context.mathTables.insert(table);
+            const std::string at = path(table + "_at") + MC_FUNCTION_WITH(MC_MATH_ARGUMENTS);
+            push(mc_command(false, MC_SCOREBOARD_CMD_ID, PADR(players get) + i).storeResult(PADR(storage) RS_PROGRAM_STORAGE SEP MC_MATH_ARGUMENTS ".i", "int", 1));
+            push(mc_command(false, MC_FUNCTION_CMD_ID, at).storeResult(PADR(score) + a));
+            push(mc_command(false, MC_SCOREBOARD_CMD_ID, PADR(players add) + i + " 1").storeResult(PADR(storage) RS_PROGRAM_STORAGE SEP MC_MATH_ARGUMENTS ".i", "int", 1));
+            push(mc_command(false, MC_FUNCTION_CMD_ID, at).storeResult(PADR(score) + b));
+            op(b, "-=", a);
+            op(b, "*=", fraction);
+            opConst(b, "/=", denominator);
+            op(a, "+=", b);
+        };
+        const std::string minus = MC_CONSTANT(STR(-1));
+        auto when = [&](const std::string& condition, const std::string& command)
+        {
+            create_and_push(MC_EXEC_CMD_ID, "if score " + condition + " run " + command);
+        };
+
+        // angles are in millidegrees, one table entry per degree.
+        if (context.mathFunctions.contains("sin"))
+        {
+            opConst(x, "%=", 360 * RS_MATH_SCALE);
+            op(i, "=", x);
+            opConst(i, "/=", RS_MATH_SCALE);
+            opConst(x, "%=", RS_MATH_SCALE);
+            lerp("sin", x, RS_MATH_SCALE);
+            returnScore(a);
+            emit("sin");
+        }
+        if (context.mathFunctions.contains("cos"))
+        {
+            create_and_push(MC_SCOREBOARD_CMD_ID, PADR(players add) + x + SEP + STR(90 * RS_MATH_SCALE));
+            create_and_push(MC_RETURN_CMD_ID, "run function " + path("sin"));
+            emit("cos");
+        }
+        // x is brought into the table (256..1023) by a power of 4, sqrt(x) = sqrt(x / 4^k) * 2^k.
+        if (context.mathFunctions.contains("sqrt"))
+        {
+            mccmdlist dispatch{mc_command{false, MC_EXEC_CMD_ID, "if score " + x + " matches ..-1 run return 0"}};
+            for(int k = 0; k < 12; k++)
+            {
+                const int64_t step = int64_t(1) << (2 * k);
+                if (k == 0)
+                {
+                    push(mc_command(false, MC_SCOREBOARD_CMD_ID, PADR(players get) + x).storeResult(PADR(storage) RS_PROGRAM_STORAGE SEP MC_MATH_ARGUMENTS ".i", "int", 1));
+                    create_and_push(MC_RETURN_CMD_ID, "run function " + path("sqrt_at") + MC_FUNCTION_WITH(MC_MATH_ARGUMENTS));
+                    context.mathTables.insert("sqrt");
+                }
+                else
+                {
+                    op(i, "=", x);
+                    opConst(i, "/=", step);
+                    opConst(x, "%=", step);
+                    lerp("sqrt", x, step);
+                    opConst(a, "*=", 1 << k);
+                    returnScore(a);
+                }
+                emit("sqrt_" + STR(k));
+                const std::string range = k == 0  ? "..1023"
+                                        : k == 11 ? STR(256 * step) + ".."
+                                                  : STR(256 * step) + ".." + STR(1024 * step - 1);
+                dispatch.push_back(mc_command{false, MC_EXEC_CMD_ID, "if score " + x + " matches " + range + " run return run function " + path("sqrt_" + STR(k))});
+            }
+            for(auto& cmd : dispatch)
+                push(cmd);
+            emit("sqrt");
+        }
+        // the smaller of |x| and |y| over the larger is in the table, the octant is put back after.
+        if (context.mathFunctions.contains("atan2"))
+        {
+            create_and_push(MC_EXEC_CMD_ID, "if score " + x + " matches 0 if score " + y + " matches 0 run return 0");
+            op(n, "=", y);
+            op(d, "=", x);
+            when(n + " matches ..-1", PADR(scoreboard players operation) + n + " *= " + minus);
+            when(d + " matches ..-1", PADR(scoreboard players operation) + d + " *= " + minus);
+            context.constants.insert(-1);
+            op(a, "=", n);
+            when(n + " > " + d, PADR(scoreboard players operation) + n + " = " + d);
+            when(a + " > " + d, PADR(scoreboard players operation) + d + " = " + a);
+            opConst(n, "*=", RS_MATH_SCALE);
+            op(n, "/=", d);
+            op(i, "=", n);
+            opConst(i, "/=", 10);
+            opConst(n, "%=", 10);
+            lerp("atan", n, 10);
+            // above the diagonal, then left, then below the x axis.
+            op(b, "=", y);
+            when(b + " matches ..-1", PADR(scoreboard players operation) + b + " *= " + minus);
+            op(d, "=", x);
+            when(d + " matches ..-1", PADR(scoreboard players operation) + d + " *= " + minus);
+            when(b + " > " + d, PADR(scoreboard players operation) + a + " *= " + minus);
+            when(b + " > " + d, PADR(scoreboard players add) + a + SEP + STR(90 * RS_MATH_SCALE));
+            when(x + " matches ..-1", PADR(scoreboard players operation) + a + " *= " + minus);
+            when(x + " matches ..-1", PADR(scoreboard players add) + a + SEP + STR(180 * RS_MATH_SCALE));
+            when(y + " matches ..-1", PADR(scoreboard players operation) + a + " *= " + minus);
+            returnScore(a);
+            emit("atan2");
+        }
+        // x to the power of e by squaring, one step per bit of e (up to 31).
+        if (context.mathFunctions.contains("pow"))
+        {
+            create_and_push(MC_SCOREBOARD_CMD_ID, PADR(players set) + a + SEP + STR(RS_MATH_SCALE));
+            create_and_push(MC_EXEC_CMD_ID, "if score " + e + " matches ..-1 run return 0");
+            for(int bit = 0; bit < 5; bit++)
+            {
+                op(b, "=", e);
+                opConst(b, "%=", 2);
+                when(b + " matches 1", PADR(scoreboard players operation) + a + " *= " + x);
+                when(b + " matches 1", PADR(scoreboard players operation) + a + " /= " + MC_CONSTANT(STR(RS_MATH_SCALE)));
+                opConst(e, "/=", 2);
+                when(e + " matches 0", "return run scoreboard players get " + a);
+                op(x, "*=", x);
+                opConst(x, "/=", RS_MATH_SCALE);
+            }
+            returnScore(a);
+            emit("pow");
+        }
+        for(const std::string& table : context.mathTables)
+        {
+            push(mc_command{true, MC_RETURN_CMD_ID, "run data get storage " RS_PROGRAM_STORAGE SEP MC_MATH_TABLE(table) + "[" + MC_MACRO(std::string("i")) + "]"});
+            emit(table + "_at");
+        }
+        return THIS;
+    }
+#pragma endregion math
+#pragma region lists
+    std::string           CommandFactory::useList          (const std::string& name)
+    {
+        context.listFunctions.insert(name);
+        return functionPath(context.module, {RS_LIST_DIRECTORY}, "", name);
+    }
+    // copies an element at a variable index to the slot of the element (or the slot back into the list),
+    // the paths of both and the index are the arguments of the macro.
+    CommandFactory::_This CommandFactory::listElement      (rs_variable& var, const bool store)
+    {
+        rs_variable& index = *var.comp_info.index;
+        create_and_push(MC_DATA_CMD_ID, MC_DATA(modify storage, MC_LIST_ARGUMENTS) PAD(set value) MC_LIST_ARGUMENTS_JSON(variablePath(*var.parent), variablePath(var)));
+        if (index.comp_info.scoreboard)
+            add(getVariableValue(index).storeResult(PADR(storage) RS_PROGRAM_STORAGE SEP MC_LIST_ARGUMENTS ".i", "int", 1));
+        else
+            copyStorage(MC_LIST_ARGUMENTS ".i", variablePath(index));
+        create_and_push(MC_FUNCTION_CMD_ID, useList(store ? "set" : "get") + MC_FUNCTION_WITH(MC_LIST_ARGUMENTS));
+        return THIS;
+    }
+    CommandFactory::_This CommandFactory::listLibrary      ()
+    {
+        const std::string element = RS_PROGRAM_STORAGE SEP MC_MACRO(std::string("element"));
+        const std::string at      = RS_PROGRAM_STORAGE SEP MC_MACRO(std::string("list")) "[" MC_MACRO(std::string("i")) "]";
+        for(const std::string& name : context.listFunctions)
+        {
+            const bool store = name == "set";
+            add(mc_command{true, MC_DATA_CMD_ID, PADR(modify storage) + (store ? at : element) + PADL(set from storage) SEP + (store ? element : at)});
+            context.functions.push_back(mc_function{name, package(), {RS_LIST_DIRECTORY}});
+            clear();
+        }
+        return THIS;
+    }
+    mc_command            CommandFactory::removeFirst      (rs_variable& list)
+    {
+        return mc_command{false, MC_DATA_CMD_ID, MC_DATA(remove storage, INS(variablePath(list))) "[0]"};
+    }
+    mc_command            CommandFactory::whileNotEmpty    (rs_variable& list, const std::string& call)
+    {
+        return mc_command{false, MC_EXEC_CMD_ID, "if data storage " RS_PROGRAM_STORAGE SEP + variablePath(list) + "[0] run function " + call};
+    }
+    // the item is set to the name of each member and its value before the block is called, in the order of the names.
+    CommandFactory::_This CommandFactory::forObject        (rs_variable& object, rs_variable& item, rs_object& type, const std::string& call)
+    {
+        std::vector<std::string> members;
+        for(auto& [name, _] : type.members)
+            members.push_back(name);
+        std::sort(members.begin(), members.end());
+
+        const std::string path = variablePath(item);
+        for(const std::string& member : members)
+        {
+            create_and_push(MC_DATA_CMD_ID, MC_DATA(modify storage, INS(path)) PAD(set value) MC_FOR_PAIR_JSON(member));
+            copyStorage(path + "." RS_FOR_PAIR_VALUE, variablePath(object) + '.' + member);
+            create_and_push(MC_FUNCTION_CMD_ID, call);
+        }
+        return THIS;
+    }
+#pragma endregion lists
+#pragma region maps
+    // a map is `{values:{"<key>":<value>}, entries:[{i1:"<key>",i2:<value>}]}`, the compound for keyed access and the
+    // list (of pairs) for for loops. the key and the map's path are either known or macro arguments, $(key) and $(map).
+    // get and has are a path into the compound, set and remove also find the key's pair in the list, going over it.
+    mccmdlist             CommandFactory::mapCommands      (const std::string& op, const std::string& map, const std::string& key, const std::string& source, const bool macro)
+    {
+        const std::string value = MC_MAP_VALUE(map, key), entry = MC_MAP_ENTRY(map, key);
+        if (op == "set")
+            return {mc_command{macro, MC_EXEC_CMD_ID, "unless data storage " RS_PROGRAM_STORAGE SEP + value + " run data modify storage " RS_PROGRAM_STORAGE SEP
+                                                      + map + "." RS_MAP_ENTRIES " append value " MC_FOR_PAIR_JSON(key)},
+                    mc_command{macro, MC_DATA_CMD_ID, MC_DATA(modify storage, INS(entry)) "." RS_FOR_PAIR_VALUE " set " + source},
+                    mc_command{macro, MC_DATA_CMD_ID, MC_DATA(modify storage, INS(value)) " set " + source}};
+        // a missing key returns 0, not the value returned last.
+        if (op == "get")
+            return {mc_command{false, MC_DATA_CMD_ID, MC_DATA(modify storage, RS_PROGRAM_RETURN_REGISTER) PAD(set value) "0"},
+                    mc_command{macro, MC_DATA_CMD_ID, MC_DATA(modify storage, RS_PROGRAM_RETURN_REGISTER) PAD(set from storage) RS_PROGRAM_STORAGE SEP + value}};
+        if (op == "has")
+            return {mc_command{macro, MC_EXEC_CMD_ID, "if data storage " RS_PROGRAM_STORAGE SEP + value}};
+        return {mc_command{macro, MC_DATA_CMD_ID, MC_DATA(remove storage, INS_L(value))},
+                mc_command{macro, MC_DATA_CMD_ID, MC_DATA(remove storage, INS_L(entry))}};
+    }
+    std::string           CommandFactory::useMap           (const std::string& name)
+    {
+        context.mapFunctions.insert(name);
+        return functionPath(context.module, {RS_MAP_DIRECTORY}, "", name);
+    }
+    // the operations with a key only known at runtime, `_map/<op>` is called with its arguments in args.map.
+    CommandFactory::_This CommandFactory::mapLibrary       ()
+    {
+        for(const std::string& name : context.mapFunctions)
+        {
+            for(mc_command& cmd : mapCommands(name, MC_MACRO(std::string("map")), MC_MACRO(std::string("key")),
+                                              "from storage " RS_PROGRAM_STORAGE SEP MC_MAP_ARGUMENTS ".v", true))
+            {
+                // the function's result is whether the key is there.
+                if (name == "has")
+                    cmd = mc_command{true, MC_RETURN_CMD_ID, "run execute " + cmd.body};
+                add(cmd);
+            }
+            context.functions.push_back(mc_function{name, package(), {RS_MAP_DIRECTORY}});
+            clear();
+        }
+        return THIS;
+    }
+#pragma endregion maps
+#pragma region heap
+    // a ref is a score, unless its function can be entered again before the ref is freed.
+    bool                  CommandFactory::scoredHandle     (const rs_variable& var)
+    {
+        const rs_type_info& type = var.type_info;
+        return type.type_id == RS_REF_KW_ID && !type.array_count && type.otherTypes.empty()
+            && !context.recursiveFrame && context.asyncFrame.empty();
+    }
+    std::string           CommandFactory::useHeap          (const std::string& name)
+    {
+        context.heapFunctions.insert(name);
+        return functionPath(context.module, {RS_HEAP_DIRECTORY}, "", name);
+    }
+    // the id of the slot the next heap function is called on, `args.heap.h`.
+    CommandFactory::_This CommandFactory::heapArgument     (rbc_value& handle)
+    {
+        switch(handle.index())
+        {
+            case 0:
+                create_and_push(MC_DATA_CMD_ID, MC_DATA(modify storage, MC_HEAP_ARGUMENTS) PAD(set value) "{h:" INS(std::get<0>(handle).val) "}");
+                break;
+            case 1:
+            {
+                rbc_register& reg = *std::get<1>(handle);
+                if (reg.operable)
+                    add(storeRegister(reg, MC_HEAP_ARGUMENTS ".h", false));
+                else
+                    copyStorage(MC_HEAP_ARGUMENTS ".h", ARR_AT(RS_PROGRAM_REGISTERS, STR(reg.id)));
+                break;
+            }
+            case 2:
+                heapArgument(*std::get<2>(handle));
+                break;
+            default:
+                break;
+        }
+        return THIS;
+    }
+    CommandFactory::_This CommandFactory::heapArgument     (rs_variable& handle)
+    {
+        if (handle.comp_info.scoreboard)
+            add(getVariableValue(handle).storeResult(PADR(storage) RS_PROGRAM_STORAGE SEP MC_HEAP_ARGUMENTS ".h", "int", 1));
+        else
+            copyStorage(MC_HEAP_ARGUMENTS ".h", variablePath(handle));
+        return THIS;
+    }
+    // frees the slots of the ref variables created since `from`, the last one first.
+    CommandFactory::_This CommandFactory::freeHandles      (size_t from)
+    {
+        for(size_t i = context.heapRefs.size(); i-- > from;)
+        {
+            heapArgument(*context.heapRefs.at(i));
+            create_and_push(MC_FUNCTION_CMD_ID, useHeap("free") + MC_FUNCTION_WITH(MC_HEAP_ARGUMENTS));
+        }
+        return THIS;
+    }
+    // `new` takes the last freed id if there is one, otherwise the one after the last id given out. it's returned,
+    // and left in args.heap for `set`. the other functions are macros on the id in args.heap, `$(h)`.
+    CommandFactory::_This CommandFactory::heapLibrary      (const std::string& module)
+    {
+        const std::string slot = MC_HEAP_SLOT(MC_MACRO(std::string("h")));
+        const std::string id   = MC_HEAP_ARGUMENTS ".h";
+        const std::string next = MC_HEAP_SCORE(std::string("next"));
+        const std::string free = RS_PROGRAM_HEAP_FREE "[-1]";
+        for(const std::string& name : context.heapFunctions)
+        {
+            if (name == "new")
             {
-                rbc_register& reg = *std::get<sharedt<rbc_register>>(val);
-                add(getRegisterValue(reg).storeResult(
-                    PADR(storage) RS_PROGRAM_DATA SEP RS_PROGRAM_STACK
-                ));
-                break;
+                create_and_push(MC_DATA_CMD_ID, MC_DATA(modify storage, INS(id)) PAD(set from storage) RS_PROGRAM_STORAGE SEP INS_L(free));
+                create_and_push(MC_DATA_CMD_ID, MC_DATA(remove storage, INS_L(free)));
+                create_and_push(MC_RETURN_CMD_ID, "run data get storage " RS_PROGRAM_STORAGE SEP + id);
+                context.functions.push_back(mc_function{"reuse", package(), {RS_HEAP_DIRECTORY}});
+                clear();
+
+                create_and_push(MC_EXEC_CMD_ID, "if data storage " RS_PROGRAM_STORAGE SEP RS_PROGRAM_HEAP_FREE "[0] run return run function "
+                                                + functionPath(module, {RS_HEAP_DIRECTORY}, "", "reuse"));
+                create_and_push(MC_SCOREBOARD_CMD_ID, PADR(players add) INS(next) " 1");
+                add(mc_command(false, MC_SCOREBOARD_CMD_ID, PADR(players get) INS_L(next)).storeResult(PADR(storage) RS_PROGRAM_STORAGE SEP INS_L(id), "int", 1));
+                create_and_push(MC_RETURN_CMD_ID, "run scoreboard players get " + next);
             }
-            case 2:
+            else if (name == "set")
+                add(mc_command{true, MC_DATA_CMD_ID, MC_DATA(modify storage, INS(slot)) PAD(set from storage) RS_PROGRAM_STORAGE SEP MC_HEAP_ARGUMENTS ".v"});
+            else if (name == "get")
+                add(mc_command{true, MC_DATA_CMD_ID, MC_DATA(modify storage, RS_PROGRAM_RETURN_REGISTER) PAD(set from storage) RS_PROGRAM_STORAGE SEP INS_L(slot)});
+            else
             {
-                rs_variable& var = *std::get<sharedt<rs_variable>>(val);
-                appendStorage(RS_PROGRAM_STORAGE SEP RS_PROGRAM_STACK, MC_VARIABLE_VALUE(var.comp_info.varIndex));
-                break;
+                // freeing a slot twice would give its id out twice.
+                add(mc_command{true, MC_EXEC_CMD_ID, "unless data storage " RS_PROGRAM_STORAGE SEP + slot + " run return 0"});
+                add(mc_command{true, MC_DATA_CMD_ID, MC_DATA(remove storage, INS_L(slot))});
+                add(mc_command{true, MC_DATA_CMD_ID, MC_DATA(modify storage, RS_PROGRAM_HEAP_FREE) PAD(append value) MC_MACRO(std::string("h"))});
             }
+            context.functions.push_back(mc_function{name, package(), {RS_HEAP_DIRECTORY}});
+            clear();
         }
         return THIS;
     }
-    CommandFactory::_This CommandFactory::invoke           (const std::string& module, rbc_function& func)
+#pragma endregion heap
+    CommandFactory::_This CommandFactory::macroArgument    (rs_variable& param, rbc_value& val)
     {
-        // TODO: MACROS & NAMESPACES
+        if (val.index() != 0)
+            return setVariableValue(param, val);
 
-        std::string parentHashStr = func.getParentHashStr();
-        if (!parentHashStr.empty()) parentHashStr.push_back('_');
-
-        if (func.modulePath.empty())
-            create_and_push(MC_FUNCTION_CMD_ID, module + ':' + parentHashStr + func.name);
-        else
-        {
-            std::string path;
-            for(std::string& s : func.modulePath)
-                path += s + '/';
+        // selectors are kept without their @, which the command places before $(name).
+        rbc_constant& c = std::get<0>(val);
+        std::string value = c.val;
+        if (c.val_type == token_type::STRING_LITERAL || c.val_type == token_type::SELECTOR_LITERAL)
+            value = c.quoted();
 
-            create_and_push(MC_FUNCTION_CMD_ID, module + ':' + path + parentHashStr + func.name);
-        }
+        _macroCompound += (_macroCompound.empty() ? "" : ",") + param.name + ':' + value;
+        return THIS;
+    }
+    CommandFactory::_This CommandFactory::passMacroArguments(rbc_function& func)
+    {
+        if (func.macroArguments.empty())
+            return THIS;
+        // written before the buffered argument copies, which would be overwritten otherwise.
+        create_and_push(MC_DATA_CMD_ID, MC_DATA(modify storage, INS(func.macroArguments)) PAD(set value) "{" INS(_macroCompound) "}");
+        _macroCompound.clear();
         return THIS;
     }
+    bool                  CommandFactory::prefersMacroCall (uint commandUses)
+    {
+        const uint64_t macroCost   = RS_MACRO_CALL_COST + commandUses * RS_MACRO_LINE_COST;
+        const uint64_t storageCost = commandUses > 0 ? RS_STORAGE_COMMAND_COST : 0;
+        return macroCost < storageCost;
+    }
     CommandFactory::_This CommandFactory::popParameter     ()
     {
-        rs_variable* var = context.stack.back();
-        create_and_push(MC_DATA_CMD_ID, MC_DATA(remove storage, ARR_AT(RS_PROGRAM_VARIABLES, STR(var->comp_info.varIndex))));
+        // parameters are pushed onto the variables list, the callee has removed everything after them.
+        create_and_push(MC_DATA_CMD_ID, MC_DATA(remove storage, MC_STACK_TOP));
         context.stack.pop_back();
         return THIS;
     }
@@ -2026,12 +4122,26 @@ namespace conversion
             return mc_command(false, MC_SCOREBOARD_CMD_ID, MC_OPERABLE_REG_GET(reg.id));
         return mc_command(false, MC_DATA_CMD_ID, MC_NOPERABLE_REG_GET(reg.id));
     }
+    mc_command            CommandFactory::storeRegister    (rbc_register& reg, const std::string& path, const bool fixed)
+    {
+        const std::string where = PADR(storage) RS_PROGRAM_STORAGE SEP + path;
+        if (reg.scale == 1)
+            return getRegisterValue(reg).storeResult(where, fixed ? "double" : "int", 1);
+        return getRegisterValue(reg).storeResult(where + (fixed ? " double " : " int ") + mc_fixed_factor(reg.scale));
+    }
+    int                   CommandFactory::fixedScale       (const rs_type_info& type)
+    {
+        if (type.type_id != RS_FLOAT_KW_ID)
+            return 1;
+        return type.scale ? type.scale : RS_FLOAT_SCALE;
+    }
     mc_command            CommandFactory::getStackValue    (long index)
     {
         return mc_command(false, MC_DATA_CMD_ID, MC_GET_STACK_VALUE(index));
     }
     CommandFactory::_This CommandFactory::setVariableValue (rs_variable& var, rbc_value& val)
     {
+        const std::string path = variablePath(var);
         switch(val.index())
         {
             // constant
@@ -2039,7 +4149,51 @@ namespace conversion
             {
                 rbc_constant& c = std::get<0>(val);
                 c.quoteIfStr();
-                create_and_push(MC_DATA_CMD_ID, MC_VARIABLE_SET_CONST(var.comp_info.varIndex, c.val));
+                // a fixed point score holds the value times its scale.
+                if (var.comp_info.scoreboard && fixedScale(var.type_info) != 1)
+                    create_and_push(MC_SCOREBOARD_CMD_ID, MC_SCORE_SET(path, STR(std::llround(std::stod(c.val) * fixedScale(var.type_info)))));
+                else if (var.comp_info.scoreboard)
+                    create_and_push(MC_SCOREBOARD_CMD_ID, MC_SCORE_SET(path, c.val));
+                // selectors may contain brackets, so they are stored as strings.
+                else if (c.val_type == token_type::SELECTOR_LITERAL)
+                    create_and_push(MC_DATA_CMD_ID, MC_DATA(modify storage, INS(path)) PAD(set value) INS_L(c.quoted()));
+                else
+                    create_and_push(MC_DATA_CMD_ID, MC_DATA(modify storage, INS(path)) PAD(set value) INS_L(c.val));
+                break;
+            }
+            // register
+            case 1:
+            {
+                rbc_register& reg = *std::get<1>(val);
+                if (var.comp_info.scoreboard)
+                {
+                    rescale(reg, fixedScale(var.type_info));
+                    if (reg.operable)
+                        create_and_push(MC_SCOREBOARD_CMD_ID, MC_SCORE_COPY(path, MC_OPERABLE_REG(INS_L(STR(reg.id)))));
+                    else
+                        add(getRegisterValue(reg).storeResult(PADR(score) INS_L(path)));
+                }
+                else if (reg.operable)
+                    add(storeRegister(reg, path, fixedScale(var.type_info) != 1));
+                else
+                    copyStorage(path, ARR_AT(RS_PROGRAM_REGISTERS, STR(reg.id)));
+                break;
+            }
+            // variable
+            case 2:
+            {
+                rs_variable& from = *std::get<2>(val);
+                if (var.comp_info.scoreboard && from.comp_info.scoreboard)
+                    create_and_push(MC_SCOREBOARD_CMD_ID, MC_SCORE_COPY(path, variablePath(from)));
+                else if (var.comp_info.scoreboard)
+                    add(getVariableValue(from).storeResult(PADR(score) INS_L(path)));
+                else if (from.comp_info.scoreboard)
+                    add(getVariableValue(from).storeResult(PADR(storage) RS_PROGRAM_STORAGE SEP INS_L(path), "int", 1));
+                // a float given to an int is truncated.
+                else if (fixedScale(var.type_info) == 1 && fixedScale(from.type_info) != 1)
+                    add(getVariableValue(from).storeResult(PADR(storage) RS_PROGRAM_STORAGE SEP INS_L(path), "int", 1));
+                else
+                    copyStorage(path, variablePath(from));
                 break;
             }
             default:
@@ -2047,6 +4201,37 @@ namespace conversion
         }
         return THIS;
     }
+    CommandFactory::_This CommandFactory::storeReturn      (rs_variable& var)
+    {
+        if (var.comp_info.scoreboard)
+        {
+            add(mc_command(false, MC_DATA_CMD_ID, MC_DATA(get storage, RS_PROGRAM_RETURN_REGISTER)).storeResult(PADR(score) INS_L(variablePath(var))));
+            return THIS;
+        }
+        copyStorage(variablePath(var), RS_PROGRAM_RETURN_REGISTER);
+
+        const std::string typePath = variableTypePath(var);
+        if (!typePath.empty())
+            copyStorage(typePath, RS_PROGRAM_RETURN_TYPE_REGISTER);
+        return THIS;
+    }
+    CommandFactory::_This CommandFactory::allocateSlot     (rs_variable& param)
+    {
+        const rs_type_info& type = param.type_info;
+        const uint id = context.parameterSlots++;
+
+        // integers (and handles) are kept on the scoreboard, so the callee can operate on them without reading storage.
+        param.comp_info.scoreboard = (type.type_id == RS_INT_KW_ID || type.type_id == RS_REF_KW_ID) && type.array_count == 0 && type.otherTypes.empty();
+        param.comp_info.macro = false;
+        if (param.comp_info.scoreboard)
+        {
+            param.comp_info.slot = MC_PARAMETER_SCORE_SLOT(id);
+            context.scoreboardSlots = true;
+        }
+        else
+            param.comp_info.slot = MC_PARAMETER_SLOT(id);
+        return THIS;
+    }
     CommandFactory::_This CommandFactory::setRegisterValue (rbc_register& reg, rbc_value& value)
     {
         switch(value.index())
@@ -2055,7 +4240,13 @@ namespace conversion
             {
                 rbc_constant& val = std::get<rbc_constant>(value);
                 val.quoteIfStr();
-                if (reg.operable)
+                reg.scale = 1;
+                if (reg.operable && val.val_type == token_type::FLOAT_LITERAL)
+                {
+                    reg.scale = RS_FLOAT_SCALE;
+                    create_and_push(MC_SCOREBOARD_CMD_ID, MC_OPERABLE_REG_SET(reg.id, STR(std::llround(std::stod(val.val) * reg.scale))));
+                }
+                else if (reg.operable)
                     create_and_push(MC_SCOREBOARD_CMD_ID, MC_OPERABLE_REG_SET(reg.id, val.val));
                 else
                     create_and_push(MC_DATA_CMD_ID, MC_DATA(modify storage, ARR_AT(RS_PROGRAM_REGISTERS, STR(reg.id)))
@@ -2070,10 +4261,13 @@ namespace conversion
             case 2:
             {
                 rs_variable& var = *std::get<2>(value);
-                if (reg.operable)
+                reg.scale = fixedScale(var.type_info);
+                if (reg.operable && var.comp_info.scoreboard)
+                    create_and_push(MC_SCOREBOARD_CMD_ID, MC_SCORE_COPY(MC_OPERABLE_REG(INS_L(STR(reg.id))), variablePath(var)));
+                else if (reg.operable)
                 {
-                    mc_command cmd = CommandFactory::getVariableValue(var).storeResult(
-                        PADR(score) MC_OPERABLE_REG(INS_L(STR(reg.id)))
+                    mc_command cmd = CommandFactory::getVariableValue(var, reg.scale).storeResult(
+                        PADR(score) + MC_OPERABLE_REG(INS_L(STR(reg.id)))
                     );
                     
                     add(cmd);
@@ -2084,9 +4278,63 @@ namespace conversion
         }
         return THIS;
     }
-    mc_command            CommandFactory::getVariableValue (rs_variable& var)
+    // read from storage times scale, a float with its fixed point scale is a whole number.
+    mc_command            CommandFactory::getVariableValue (rs_variable& var, int scale)
+    {
+        if (var.comp_info.scoreboard)
+            return mc_command(false, MC_SCOREBOARD_CMD_ID, PADR(players get) INS_L(variablePath(var)));
+        if (scale != 1)
+            return mc_command(false, MC_DATA_CMD_ID, MC_DATA(get storage, INS(variablePath(var))) SEP INS_L(STR(scale)));
+        return mc_command(false, MC_DATA_CMD_ID, MC_DATA(get storage, INS_L(variablePath(var))));
+    }
+    // storage path of a variable, or its score holder if it lives on the scoreboard.
+    std::string           CommandFactory::variablePath     (rs_variable& var)
     {
-        return mc_command(false, MC_DATA_CMD_ID, MC_GET_VARIABLE_VALUE(var.comp_info.varIndex));
+        // elements at a variable index are read into (and written from) a slot of their own.
+        if (var.comp_info.index)
+        {
+            if (var.comp_info.slot.empty())
+                var.comp_info.slot = MC_LIST_ELEMENT(context.listElements++);
+            return var.comp_info.slot;
+        }
+        if (var.comp_info.head)
+            return variablePath(*var.comp_info.head) + "[0]";
+        // a member of a scoreboard object is a score of the entity, `@s stats_points`.
+        if (var.parent && !var.parent->comp_info.holder.empty())
+            return var.parent->comp_info.holder + SEP + MC_FIELD_OBJECTIVE(var.parent->fromObject->name, var.name);
+        if (var.parent)
+            return variablePath(*var.parent) + (var.name.front() == '[' ? "" : ".") + var.name;
+        if (!var.comp_info.slot.empty())
+            return var.comp_info.slot;
+        if (!var.comp_info.stacked)
+            return MC_VARIABLE_SLOT(var.comp_info.varIndex);
+        // loaded variables are at the bottom of the list, under everything created later.
+        if (var.comp_info.loaded)
+            return MC_VARIABLE_VALUE(var.comp_info.varIndex);
+        return MC_VARIABLE_VALUE(stackOffset(var));
+    }
+    // empty if the type of the variable is only known at compile time (members, parameter slots,
+    // and with the flat layout every variable that can't hold more than one type).
+    std::string           CommandFactory::variableTypePath (rs_variable& var)
+    {
+        if (var.parent || var.comp_info.head || !var.comp_info.slot.empty())
+            return "";
+        if (!var.comp_info.stacked)
+            return dynamicallyTyped(var) ? MC_VARIABLE_SLOT_TYPE(var.comp_info.varIndex) : "";
+        if (var.comp_info.loaded)
+            return MC_VARIABLE_TYPE(var.comp_info.varIndex);
+        return MC_VARIABLE_TYPE(stackOffset(var));
+    }
+    // stacked variables are indexed from the end of the list (-1 is the last one created), its length
+    // at this point being known as every scope removes the variables it created when it ends.
+    int                   CommandFactory::stackOffset      (rs_variable& var)
+    {
+        return var.comp_info.varIndex - static_cast<int>(context.varStackCount);
+    }
+    bool                  CommandFactory::dynamicallyTyped (const rs_variable& var)
+    {
+        const rs_type_info& type = var.type_info;
+        return type.type_id == -1 || type.optional || !type.otherTypes.empty();
     }
     std::shared_ptr<comparison_register> CommandFactory::compareNull   (const bool scoreboard, const std::string& where, const bool eq)
     {
@@ -2107,7 +4355,7 @@ namespace conversion
         {
             // if we can merge the contents of the variable into temp, then it is not 0, and not null.
             create_and_push(MC_SCOREBOARD_CMD_ID, MC_TEMP_STORAGE_SCOREBOARD_SET_RAW_CONST("0"));
-            add(makeCopyStorage(MC_TEMP_STORAGE_NAME, where).storeSuccess(PADR(score) MC_COMPARE_REG_FULL(destreg->id)));
+            add(makeCopyStorage(MC_TEMP_STORAGE_NAME, where).storeSuccess(PADR(score) + MC_COMPARE_REG_FULL(destreg->id)));
         }
 
         return destreg;
@@ -2149,12 +4397,12 @@ namespace conversion
             if (rhsIsConstant)
             {
                 create_and_push(MC_DATA_CMD_ID, MC_TEMP_STORAGE_SET_CONST(rhs));
-                mc_command cmd = makeCopyStorage(MC_TEMP_STORAGE_NAME, lhs).storeSuccess(PADR(score) MC_COMPARE_REG_FULL(reg->id));
+                mc_command cmd = makeCopyStorage(MC_TEMP_STORAGE_NAME, lhs).storeSuccess(PADR(score) + MC_COMPARE_REG_FULL(reg->id));
                 add(cmd);
             }
             else
             {
-                mc_command cmd = makeCopyStorage(MC_TEMP_STORAGE_NAME, rhs).storeSuccess(PADR(score) MC_COMPARE_REG_FULL(reg->id));
+                mc_command cmd = makeCopyStorage(MC_TEMP_STORAGE_NAME, rhs).storeSuccess(PADR(score) + MC_COMPARE_REG_FULL(reg->id));
                 copyStorage(MC_TEMP_STORAGE_NAME, lhs);
                 add(cmd);
 
@@ -2164,8 +4412,9 @@ namespace conversion
         else if (locationType == "score")
         {
             create_and_push(MC_SCOREBOARD_CMD_ID, MC_COMPARE_RESET(reg->id));
-            reg->operation = eq ? comparison_operation_type::EQ : comparison_operation_type::NEQ;
-            mc_command m{false, MC_SCOREBOARD_CMD_ID, PADR(players set) MC_COMPARE_REG_GET_RAW(INS(STR(reg->id))) PADL(1)};
+            // the register holds the result, != is already inverted by the unless below.
+            reg->operation = comparison_operation_type::EQ;
+            mc_command m{false, MC_SCOREBOARD_CMD_ID, PADR(players set) + MC_COMPARE_REG_GET_RAW(INS_L(STR(reg->id))) + PADL(1)};
 
             m.ifint(lhs, reg->operation, rhs, rhsIsConstant, !eq);
 
@@ -2178,6 +4427,12 @@ namespace conversion
 
     }
 
+    // the subcommand testing a comparison register.
+    std::string           CommandFactory::testRegister     (comparison_register& reg, const bool negate)
+    {
+        const bool eq = (reg.operation == comparison_operation_type::EQ) != negate;
+        return (eq ? "if " : "unless ") + std::string(MC_COMPARE_REG_TEST(reg.id));
+    }
     void                  CommandFactory::make             (mc_command& cmd)
     {
         if (context.blocks.size() == 0 || _nonConditionalFlag)
@@ -2232,49 +4487,123 @@ namespace conversion
     }
     CommandFactory::_This CommandFactory::createVariable   (rs_variable& var)
     {
+        const std::string value = emptyValue(var);
+        allocateVariable(var, true, value);
+        // a handle left from the last call would be freed at the end of the scope.
+        if (var.comp_info.scoreboard)
+            create_and_push(MC_SCOREBOARD_CMD_ID, MC_SCORE_SET(variablePath(var), value));
+        else if (!var.comp_info.stacked)
+            create_and_push(MC_DATA_CMD_ID, MC_DATA(modify storage, INS(variablePath(var))) PAD(set value) INS_L(value));
+        return THIS;
+    }
+    // the value of a variable created without one, maps start out empty.
+    std::string           CommandFactory::emptyValue       (const rs_variable& var)
+    {
+        return var.type_info.type_id == RS_MAP_KW_ID ? MC_MAP_EMPTY : "0";
+    }
+    // takes the next variable slot. stacked variables append their compound right away,
+    // flat slots only write the type (if they need one) and leave the value to the caller.
+    CommandFactory::_This CommandFactory::allocateVariable (rs_variable& var, const bool typed, const std::string& value)
+    {
+        // the slot of a ref is freed at the end of its scope.
+        if (var.type_info.type_id == RS_REF_KW_ID)
+            context.heapRefs.push_back(&var);
+        if (scoredHandle(var))
+        {
+            var.comp_info.scoreboard = true;
+            var.comp_info.slot = MC_HEAP_HANDLE(context.heapHandles++);
+            return THIS;
+        }
+        if (!stacks(var) && !context.asyncFrame.empty())
+        {
+            var.comp_info.varIndex = context.flatSlots++;
+            var.comp_info.slot = context.asyncFrame + '.' + mc_slot_name(var.comp_info.varIndex);
+            return THIS;
+        }
+        if (!var.comp_info.stacked)
+        {
+            var.comp_info.varIndex = context.flatSlots++;
+            context.flatSlotsEnd = std::max(context.flatSlotsEnd, context.flatSlots);
+            if (typed && dynamicallyTyped(var))
+                create_and_push(MC_DATA_CMD_ID, MC_DATA(modify storage, INS(variableTypePath(var))) PAD(set value) INS_L(STR(var.type_info.type_id)));
+            return THIS;
+        }
+        var.comp_info.varIndex = context.varStackCount++;
         create_and_push(MC_DATA_CMD_ID,
                 MC_DATA(modify storage, RS_PROGRAM_VARIABLES)
                     PAD(append value)
-                MC_VARIABLE_JSON_DEFAULT(std::to_string(var.scope),
+                MC_VARIABLE_JSON(INS(value), std::to_string(var.scope),
                                         std::to_string(var.type_info.type_id))
                         );
-        var.comp_info.varIndex = context.varStackCount++;
         return THIS;
     }
+    // the variable is created with the rest of the program data by the load function, with its value if it's a constant.
+    CommandFactory::_This CommandFactory::loadVariable     (rs_variable& var, rbc_value* val)
+    {
+        std::string value = emptyValue(var);
+        if (val && val->index() == 0)
+        {
+            rbc_constant c = std::get<0>(*val);
+            c.quoteIfStr();
+            // selectors may contain brackets, so they are stored as strings.
+            value = c.val_type == token_type::SELECTOR_LITERAL ? c.quoted() : c.val;
+        }
+        var.comp_info.loaded = true;
+        if (stacks(var))
+        {
+            var.comp_info.varIndex = context.varStackCount++;
+            context.loadedVariables.push_back(MC_VARIABLE_JSON(INS(value), std::to_string(var.scope), std::to_string(var.type_info.type_id)));
+            return THIS;
+        }
+        var.comp_info.varIndex = context.flatSlots++;
+        context.flatSlotsEnd = std::max(context.flatSlotsEnd, context.flatSlots);
+        context.loadedSlots.push_back('"' + mc_slot_name(var.comp_info.varIndex) + "\":" + value);
+        if (dynamicallyTyped(var))
+            context.loadedSlotTypes.push_back('"' + mc_slot_name(var.comp_info.varIndex) + "\":" + STR(var.type_info.type_id));
+        return THIS;
+    }
+    // recursive functions can be entered again before they return, so their frames are always stacked.
+    // variables of async functions live in their frame whatever the layout, only the parameters they push are stacked.
+    bool                  CommandFactory::stacks           (rs_variable& var)
+    {
+        if (!context.asyncFrame.empty())
+            return var.comp_info.stacked;
+        var.comp_info.stacked = var.comp_info.stacked || context.recursiveFrame || storageLayout() == mc_storage_layout::LIST;
+        return var.comp_info.stacked;
+    }
     CommandFactory::_This CommandFactory::createVariable   (rs_variable& var, rbc_value& val)
     {
         switch(val.index())
         {
             case 0:
             {
-                var.comp_info.varIndex = context.varStackCount++;
-
                 rbc_constant& c = std::get<0>(val);
+                if (!stacks(var) || scoredHandle(var))
+                {
+                    allocateVariable(var);
+                    setVariableValue(var, val);
+                    break;
+                }
+                // the value is appended with the compound.
                 c.quoteIfStr();
-                create_and_push(MC_DATA_CMD_ID,
-                    MC_DATA(modify storage, RS_PROGRAM_VARIABLES)
-                        PAD(append value)
-                    MC_VARIABLE_JSON_VAL(c.val, std::to_string(var.scope),
-                                                std::to_string(var.type_info.type_id))
-                                );
+                allocateVariable(var, true, c.val);
                 break;
             }
             case 1:
             {
-                // var.comp_info.varIndex = context.varStackCount++;
-                // handled in create variable
                 sharedt<rbc_register>& reg = std::get<1>(val);
-                createVariable(var);
-                add( getRegisterValue(*reg).storeResult(PADR(storage) MC_VARIABLE_VALUE_FULL(var.comp_info.varIndex), "int", 1) );
+                allocateVariable(var);
+                if (var.comp_info.scoreboard)
+                    setVariableValue(var, val);
+                else
+                    add( storeRegister(*reg, variablePath(var), fixedScale(var.type_info) != 1) );
                 
                 break;
             }
             case 2:
             {
-                // handled in create variable
-                sharedt<rs_variable>& variable = std::get<2>(val);
-                createVariable(var);
-                copyStorage(MC_VARIABLE_VALUE(var.comp_info.varIndex), MC_VARIABLE_VALUE(variable->comp_info.varIndex));
+                allocateVariable(var);
+                setVariableValue(var, val);
                 break;
             }
             case 3:
@@ -2285,8 +4614,122 @@ namespace conversion
         }
         return THIS;
     }
+    // variables created since the scope was entered are dead once it ends, their slots are taken again
+    // by the next variables. stacked ones are removed from the end of the list, so it doesn't grow, and the heap
+    // slots of refs are freed.
+    CommandFactory::_This CommandFactory::enterScope       ()
+    {
+        context.scopes.push_back({context.varStackCount, context.flatSlots, context.heapRefs.size()});
+        return THIS;
+    }
+    CommandFactory::_This CommandFactory::leaveScope       ()
+    {
+        if (context.scopes.empty())
+            return THIS;
+        auto [entries, slots, refs] = context.scopes.back();
+        context.scopes.pop_back();
+        freeHandles(refs);
+        context.heapRefs.resize(refs);
+        for(uint i = entries; i < context.varStackCount; i++)
+            create_and_push(MC_DATA_CMD_ID, MC_DATA(remove storage, MC_STACK_TOP));
+        context.varStackCount = entries;
+        context.flatSlots = slots;
+        return THIS;
+    }
+    // truncates the list to the caller's part (and frees the slots of the refs in scope) when the function returns,
+    // the counters are left as they are for the instructions after a conditional return.
+    CommandFactory::_This CommandFactory::leaveFrame       ()
+    {
+        freeHandles(0);
+        for(uint i = context.frameBase; i < context.varStackCount; i++)
+            create_and_push(MC_DATA_CMD_ID, MC_DATA(remove storage, MC_STACK_TOP));
+        uncacheSelectors();
+        countStorage();
+        return THIS;
+    }
+    // the tags of cached selectors only last as long as the function.
+    CommandFactory::_This CommandFactory::uncacheSelectors ()
+    {
+        for(auto& [selector, tag] : context.cachedSelectors)
+            create_and_push(MC_TAG_CMD_ID, MC_TAG_REMOVE(selector, tag));
+        return THIS;
+    }
+    // consecutive messages to the same players are sent as one, on separate lines. the message before has to be
+    // the last command, under the same conditions, so nothing it reads has changed in between.
+    CommandFactory::_This CommandFactory::message          (const std::string& selector, const std::vector<mc_text>& parts, bool macro)
+    {
+        mccmdlist& target = _useBuffer ? *_buffer : commands;
+        std::vector<mc_text> text = parts;
+        // a random selector could pick other players the second time.
+        const bool random = selector.starts_with('r') || selector.find("sort=random") != std::string::npos;
+        if (!macro && !random && selector == _lastSelector && !target.empty()
+        &&  target.back().body == _lastMessageCommand.body && !target.back().macro)
+        {
+            mc_command probe{false, MC_TELLRAW_CMD_ID, MC_TELLRAW(selector, mc_text_json(_lastMessage))};
+            make(probe);
+            if (probe.body == target.back().body)
+            {
+                target.pop_back();
+                text = _lastMessage;
+                text.push_back({true, "\\n"});
+                text.insert(text.end(), parts.begin(), parts.end());
+            }
+        }
+        mc_command cmd{macro, MC_TELLRAW_CMD_ID, MC_TELLRAW(selector, mc_text_json(text))};
+        add(cmd);
+        _lastSelector       = selector;
+        _lastMessage        = std::move(text);
+        _lastMessageCommand = cmd;
+        return THIS;
+    }
+    // the result (or success) of an inbuilt function's command is its int return value.
+    CommandFactory::_This CommandFactory::returnResult     (mc_command cmd, bool result)
+    {
+        const std::string where = PADR(storage) RS_PROGRAM_STORAGE SEP RS_PROGRAM_RETURN_REGISTER;
+        add(result ? cmd.storeResult(where, "int", 1) : cmd.storeSuccess(where, "int", 1));
+        create_and_push(MC_DATA_CMD_ID, MC_DATA(modify storage, RS_PROGRAM_RETURN_TYPE_REGISTER) PAD(set value) INS_L(STR(RS_INT_KW_ID)));
+        return THIS;
+    }
+    CommandFactory::_This CommandFactory::returnConstant   (int value)
+    {
+        create_and_push(MC_DATA_CMD_ID, MC_DATA(modify storage, RS_PROGRAM_RETURN_REGISTER) PAD(set value) INS_L(STR(value)));
+        create_and_push(MC_DATA_CMD_ID, MC_DATA(modify storage, RS_PROGRAM_RETURN_TYPE_REGISTER) PAD(set value) INS_L(STR(RS_INT_KW_ID)));
+        return THIS;
+    }
+    CommandFactory::_This CommandFactory::schedule         (rbc_function& func, const std::string& ticks)
+    {
+        create_and_push(MC_SCHEDULE_CMD_ID, MC_SCHEDULE_DELAY(functionPath(context.module, func.modulePath, func.getParentHashStr(), func.name), ticks));
+        return THIS;
+    }
+    // `debug=storage` in rs.config keeps the size of the variable storage on the debug objective.
+    CommandFactory::_This CommandFactory::countStorage     ()
+    {
+        if (!RS_CONFIG.exists("debug") || RS_CONFIG.get<std::string>("debug") != "storage")
+            return THIS;
+        add(mc_command(false, MC_DATA_CMD_ID, MC_DATA(get storage, RS_PROGRAM_VARIABLES)).storeResult(PADR(score) MC_DEBUG_COUNTER(RS_PROGRAM_VARIABLES)));
+        if (storageLayout() == mc_storage_layout::FLAT)
+            add(mc_command(false, MC_DATA_CMD_ID, MC_DATA(get storage, RS_PROGRAM_SLOTS)).storeResult(PADR(score) MC_DEBUG_COUNTER(RS_PROGRAM_SLOTS)));
+        return THIS;
+    }
+    // the fixed point scale of an operand, a float literal is read at the default scale.
+    static int operandScale(rbc_value& val)
+    {
+        switch(val.index())
+        {
+            case 0:
+                return std::get<0>(val).val_type == token_type::FLOAT_LITERAL ? RS_FLOAT_SCALE : 1;
+            case 1:
+                return std::get<1>(val)->scale;
+            case 2:
+                return CommandFactory::fixedScale(std::get<2>(val)->type_info);
+            default:
+                return 1;
+        }
+    }
     CommandFactory::_This CommandFactory::op_reg_math      (rbc_register& reg, rbc_value& val, bst_operation_type t)
     {
+        if (reg.scale != 1 || operandScale(val) != 1)
+            return fixed_reg_math(reg, val, t);
         switch(val.index())
         {
             case 0:
@@ -2294,8 +4737,10 @@ namespace conversion
                 rbc_constant& c = std::get<0>(val);
                 c.quoteIfStr();
                 // we can add/subtract constants easily using scoreboard add/remove.
-                // with other operations however, we cant, and need to store this constant in the next free register.
-                
+                // other operations use the constant pool, after trying to reduce them to something cheaper.
+                if (c.val_type == token_type::INT_LITERAL)
+                    return op_reg_const_math(reg, std::stoi(c.val), t);
+
                 if (t == bst_operation_type::ADD)
                 {
                     create_and_push(MC_SCOREBOARD_CMD_ID, MC_REG_INCREMENT_CONST(reg.id, c.val));
@@ -2328,10 +4773,33 @@ namespace conversion
             }
             case 1:
             {
+                rbc_register& rhReg = *std::get<1>(val);
+                if (!rhReg.operable || t == bst_operation_type::POW || t == bst_operation_type::XOR)
+                {
+                    ERROR("Unknown/Unsupported math operation between registers.");
+                    break;
+                }
+                create_and_push(MC_SCOREBOARD_CMD_ID, MC_REG_OPERATE(reg.id, operationTypeToStr(t) + '=', rhReg.id));
                 break;
             }
             case 2:
             {
+                rs_variable& var = *std::get<2>(val);
+                if (t == bst_operation_type::POW || t == bst_operation_type::XOR)
+                {
+                    ERROR("Unknown/Unsupported math operation between register and variable.");
+                    break;
+                }
+                const std::string opStr = operationTypeToStr(t) + '=';
+                // a variable on the scoreboard is an operand as it is, one in storage is read into a register first.
+                if (var.comp_info.scoreboard)
+                {
+                    create_and_push(MC_SCOREBOARD_CMD_ID, PADR(players operation) + MC_OPERABLE_REG(INS_L(STR(reg.id))) + SEP + opStr + SEP + variablePath(var));
+                    break;
+                }
+                rbc_register& rhReg = scratchRegister();
+                setRegisterValue(rhReg, val);
+                create_and_push(MC_SCOREBOARD_CMD_ID, MC_REG_OPERATE(reg.id, opStr, rhReg.id));
                 break;
             }
             default:
@@ -2340,6 +4808,201 @@ namespace conversion
         }
         return THIS;
     }
+    // both sides are brought to the larger scale, a product or quotient is scaled back by it once.
+    // constant factors are folded: x * 1.5 is x * 3 / 2.
+    CommandFactory::_This CommandFactory::fixed_reg_math   (rbc_register& reg, rbc_value& val, bst_operation_type t)
+    {
+        using T = bst_operation_type;
+        if (t == T::POW || t == T::XOR)
+        {
+            ERROR("Unsupported math operation on a float, use math::pow for powers.");
+            return THIS;
+        }
+        if (!reg.operable)
+        {
+            ERROR("Register cannot store unsupported value.");
+            return THIS;
+        }
+        const int scale = std::max(reg.scale, operandScale(val));
+        if (val.index() == 0)
+        {
+            rbc_constant& c = std::get<0>(val);
+            // a whole factor doesn't change the scale.
+            if (c.val_type == token_type::INT_LITERAL && (t == T::MUL || t == T::DIV))
+                return op_reg_const_math(reg, std::stoi(c.val), t);
+            rescale(reg, scale);
+            const long long fixed = std::llround(std::stod(c.val) * scale);
+            const long long common = std::gcd(fixed, static_cast<long long>(scale));
+            switch(t)
+            {
+                case T::MUL:
+                    op_reg_const_math(reg, static_cast<int>(fixed / common), T::MUL);
+                    op_reg_const_math(reg, static_cast<int>(scale / common), T::DIV);
+                    break;
+                case T::DIV:
+                    if (fixed == 0)
+                        return op_reg_const_math(reg, 0, T::DIV);
+                    op_reg_const_math(reg, static_cast<int>(scale / common), T::MUL);
+                    op_reg_const_math(reg, static_cast<int>(fixed / common), T::DIV);
+                    break;
+                default:
+                    op_reg_const_math(reg, static_cast<int>(fixed), t);
+            }
+            return THIS;
+        }
+        rescale(reg, scale);
+        rbc_register* rhReg = nullptr;
+        if (val.index() == 1)
+            rhReg = std::get<1>(val).get();
+        else if (val.index() == 2)
+        {
+            rhReg = &scratchRegister();
+            // read straight at the scale of the operation.
+            rs_variable& var = *std::get<2>(val);
+            if (var.comp_info.scoreboard)
+                setRegisterValue(*rhReg, val);
+            else
+            {
+                add(getVariableValue(var, scale).storeResult(PADR(score) + MC_OPERABLE_REG(INS_L(STR(rhReg->id)))));
+                rhReg->scale = scale;
+            }
+        }
+        if (!rhReg || !rhReg->operable)
+        {
+            ERROR("Unknown/Unsupported math operation between registers.");
+            return THIS;
+        }
+        rescale(*rhReg, scale);
+        switch(t)
+        {
+            case T::MUL:
+                create_and_push(MC_SCOREBOARD_CMD_ID, MC_REG_OPERATE(reg.id, "*=", rhReg->id));
+                op_reg_const_math(reg, scale, T::DIV);
+                break;
+            case T::DIV:
+                op_reg_const_math(reg, scale, T::MUL);
+                create_and_push(MC_SCOREBOARD_CMD_ID, MC_REG_OPERATE(reg.id, "/=", rhReg->id));
+                break;
+            default:
+                create_and_push(MC_SCOREBOARD_CMD_ID, MC_REG_OPERATE(reg.id, operationTypeToStr(t) + '=', rhReg->id));
+        }
+        return THIS;
+    }
+    // multiplies and divides by the reduced ratio of the scales, 1000 to 100 is one division by 10.
+    CommandFactory::_This CommandFactory::rescale          (rbc_register& reg, int scale)
+    {
+        if (reg.scale == scale || !reg.operable)
+            return THIS;
+        const int common = std::gcd(reg.scale, scale);
+        const int from = reg.scale;
+        op_reg_const_math(reg, scale / common, bst_operation_type::MUL);
+        op_reg_const_math(reg, from / common, bst_operation_type::DIV);
+        reg.scale = scale;
+        return THIS;
+    }
+    rbc_register&         CommandFactory::scratchRegister  ()
+    {
+        if (!_scratch)
+            _scratch = rbc_compiler.makeRegister(true, false);
+        return *_scratch;
+    }
+    CommandFactory::_This CommandFactory::op_reg_const_math(rbc_register& reg, int c, bst_operation_type t)
+    {
+        using T = bst_operation_type;
+        switch(t)
+        {
+            case T::ADD:
+            case T::SUB:
+            {
+                if (c == 0)
+                    break;
+                // add/remove only take positive values.
+                const bool add = (t == T::ADD) == (c > 0);
+                const std::string amount = STR(std::abs(static_cast<long long>(c)));
+                create_and_push(MC_SCOREBOARD_CMD_ID, add ? MC_REG_INCREMENT_CONST(reg.id, amount) : MC_REG_DECREMENT_CONST(reg.id, amount));
+                break;
+            }
+            case T::MUL:
+            {
+                if (c == 1)
+                    break;
+                if (c == 0)
+                {
+                    create_and_push(MC_SCOREBOARD_CMD_ID, MC_OPERABLE_REG_SET(reg.id, "0"));
+                    break;
+                }
+                // x * 2^n, doubled n times.
+                if (c > 0 && (c & (c - 1)) == 0 && std::countr_zero(static_cast<uint>(c)) <= RS_MAX_DOUBLING_ADDS)
+                {
+                    for(int n = std::countr_zero(static_cast<uint>(c)); n > 0; n--)
+                        create_and_push(MC_SCOREBOARD_CMD_ID, MC_REG_OPERATE(reg.id, "+=", reg.id));
+                    break;
+                }
+                create_and_push(MC_SCOREBOARD_CMD_ID, MC_REG_OPERATE_CONST(reg.id, "*=", constant(c)));
+                break;
+            }
+            case T::DIV:
+            {
+                if (c == 1)
+                    break;
+                if (c == 0)
+                {
+                    WARN("Division by constant 0, the value is left unchanged.");
+                    break;
+                }
+                create_and_push(MC_SCOREBOARD_CMD_ID, MC_REG_OPERATE_CONST(reg.id, c == -1 ? "*=" : "/=", constant(c)));
+                break;
+            }
+            case T::MOD:
+            {
+                if (c == 0)
+                {
+                    WARN("Modulo by constant 0, the value is left unchanged.");
+                    break;
+                }
+                if (c == 1 || c == -1)
+                {
+                    create_and_push(MC_SCOREBOARD_CMD_ID, MC_OPERABLE_REG_SET(reg.id, "0"));
+                    break;
+                }
+                create_and_push(MC_SCOREBOARD_CMD_ID, MC_REG_OPERATE_CONST(reg.id, "%=", constant(c)));
+                break;
+            }
+            case T::POW:
+            {
+                if (c < 0)
+                {
+                    ERROR("Negative exponents are not supported for integers.");
+                    break;
+                }
+                if (c == 0)
+                {
+                    create_and_push(MC_SCOREBOARD_CMD_ID, MC_OPERABLE_REG_SET(reg.id, "1"));
+                    break;
+                }
+                if (c == 1)
+                    break;
+                // square and multiply, from the highest bit down. the base is kept in another register.
+                rbc_register& base = scratchRegister();
+                create_and_push(MC_SCOREBOARD_CMD_ID, MC_REG_OPERATE(base.id, "=", reg.id));
+                for(int bit = std::bit_width(static_cast<uint>(c)) - 2; bit >= 0; bit--)
+                {
+                    create_and_push(MC_SCOREBOARD_CMD_ID, MC_REG_OPERATE(reg.id, "*=", reg.id));
+                    if (c & (1 << bit))
+                        create_and_push(MC_SCOREBOARD_CMD_ID, MC_REG_OPERATE(reg.id, "*=", base.id));
+                }
+                break;
+            }
+            default:
+                ERROR("Unknown/Unsupported math operation between register and constant.");
+        }
+        return THIS;
+    }
+    std::string           CommandFactory::constant         (int value)
+    {
+        context.constants.insert(value);
+        return STR(value);
+    }
     CommandFactory::_This CommandFactory::math             (rbc_value& lhs, rbc_value& rhs, bst_operation_type op)
     {
 
@@ -2374,6 +5037,50 @@ namespace conversion
         }
         return THIS;
     }
+    // `x += 1` on a score is done to the score itself, false when it has to go through a register.
+    bool                  CommandFactory::operateScore     (rs_variable& var, rbc_value& val, bst_operation_type t)
+    {
+        using T = bst_operation_type;
+        if (!var.comp_info.scoreboard || (t != T::ADD && t != T::SUB && t != T::MUL && t != T::DIV && t != T::MOD))
+            return false;
+        const std::string path = variablePath(var);
+        const int scale = fixedScale(var.type_info);
+        switch(val.index())
+        {
+            case 0:
+            {
+                rbc_constant& c = std::get<0>(val);
+                if (c.val_type != token_type::INT_LITERAL && (c.val_type != token_type::FLOAT_LITERAL || scale == 1))
+                    return false;
+                if (t == T::ADD || t == T::SUB)
+                {
+                    const long long amount = std::llround(std::stod(c.val) * scale);
+                    if (amount != 0)
+                        create_and_push(MC_SCOREBOARD_CMD_ID, ((t == T::ADD) == (amount > 0) ? PADR(players add) : PADR(players remove))
+                                                             + path + SEP + STR(std::llabs(amount)));
+                    return true;
+                }
+                // a whole factor keeps the scale, the remainder of a fixed point value doesn't.
+                if (c.val_type != token_type::INT_LITERAL || (t == T::MOD && scale != 1))
+                    return false;
+                const int factor = std::stoi(c.val);
+                if (factor == 0 && t != T::MUL)
+                    return false;
+                create_and_push(MC_SCOREBOARD_CMD_ID, PADR(players operation) + path + SEP + operationTypeToStr(t) + "= " + MC_CONSTANT(constant(factor)));
+                return true;
+            }
+            case 2:
+            {
+                rs_variable& from = *std::get<2>(val);
+                if (!from.comp_info.scoreboard || fixedScale(from.type_info) != scale || (scale != 1 && t != T::ADD && t != T::SUB))
+                    return false;
+                create_and_push(MC_SCOREBOARD_CMD_ID, PADR(players operation) + path + SEP + operationTypeToStr(t) + "= " + variablePath(from));
+                return true;
+            }
+            default:
+                return false;
+        }
+    }
 }
 
 
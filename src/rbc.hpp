@@ -45,7 +45,14 @@ enum class rbc_instruction
     PUSH,
     POP,
     INC, // inc scope
-    DEC  // dec scope
+    DEC, // dec scope
+    CAST, // dynamic object parsing
+    YIELD, // suspend an async function until the next tick
+    AS,    // run the block up to ENDAS as (and at) every entity of a selector
+    ENDAS,
+    INDEX, // copy a list element at a variable index to its slot, or back into the list
+    FOR,   // run the block up to ENDFOR once per element of a list copy, or per member of an object
+    ENDFOR
 };
 enum class rbc_scope_type
 {
@@ -54,6 +61,8 @@ enum class rbc_scope_type
     ELSE,
     FUNCTION,
     MODULE,
+    AS,
+    FOR,
     NONE
 };
 
@@ -79,6 +88,9 @@ enum class rbc_function_decorator
     NOCOMPILE,
     NORETURN,
     WRAPPER,
+    TICK,   // run every tick, through the tick tag.
+    VARIADIC, // inbuilt function taking any number of its last parameter.
+    ASYNC,  // may yield, resumed on the next tick with its variables.
     UNKNOWN
 };
 
@@ -90,11 +102,11 @@ public:
     void quoteIfStr()
     {
         if (val_type == token_type::STRING_LITERAL)
-            val = '"' + val + '"';
+            val = '"' + mc_escape_string(val) + '"';
     }
     inline std::string quoted()
     {
-        return '"' + val + '"';
+        return '"' + mc_escape_string(val) + '"';
     } 
     const token_type val_type; 
     std::string       val;
@@ -118,6 +130,8 @@ public:
     bool operable;
     bool vacant = true;
     uint id;
+    // a float is held as a fixed point integer, its value times scale.
+    int scale = 1;
 
     rbc_register(uint _id, bool _operable, bool _vacant)
         : id(_id), operable(_operable), vacant(_vacant)
@@ -152,6 +166,12 @@ struct rbc_command
     std::string toHumanStr();
     
 };
+// an IF condition as execute subcommands, or its value if known at compile time.
+struct rbc_condition
+{
+    std::string subcommands;
+    int constant = -1;
+};
 
 typedef std::pair<std::shared_ptr<rs_variable>, bool> rbc_func_var_t;
 
@@ -165,6 +185,8 @@ struct rbc_function
     std::string name;
     uint scope = 0;
     std::unordered_map<std::string, rbc_func_var_t> localVariables;
+    // parameter names in declaration order
+    std::vector<std::string> parameters;
     std::vector<rbc_command> instructions;
     std::vector<rbc_function_decorator> decorators;
     // made shared because of forward declaration
@@ -174,6 +196,12 @@ struct rbc_function
     std::unordered_map<std::string, std::shared_ptr<rbc_function>> childFunctions;
 
     bool hasBody = true;
+    // recursive functions keep their parameters on the stack, others use fixed slots.
+    bool recursive = false;
+    // storage compound passed to `function ... with`, empty if the function is called without macros.
+    std::string macroArguments;
+    // index of the frame and queue of an async function, -1 for others.
+    int asyncId = -1;
 
     rs_variable* getNthParameter(size_t p);
     rs_variable* getParameterByName(const std::string& name);
@@ -207,6 +235,8 @@ struct rbc_program
     rbc_scope_type lastScope;
 public:
     sharedt<rs_variable> getVariable(const std::string& name);
+    // a variable read by an expression, a list element at a variable index is fetched first.
+    sharedt<rs_variable> readVariable(const std::string& name);
     sharedt<rbc_register> getFreeRegister(bool operable = false);
     sharedt<rbc_register> makeRegister(bool operable = false, bool vacant = true);
 
@@ -235,6 +265,8 @@ namespace rbc_commands
         rbc_command create(std::shared_ptr<rs_variable> v);
         rbc_command storeReturn(std::shared_ptr<rs_variable> v);
         rbc_command set(std::shared_ptr<rs_variable> v, rbc_value val);
+        // reads (or with store, writes back) an element indexed by a variable.
+        rbc_command element(std::shared_ptr<rs_variable> v, bool store);
     };
 };
 void preprocess(token_list&, std::string, std::string&, rs_error*,
@@ -252,12 +284,28 @@ namespace conversion
 
         bool _useBuffer = false;
 
+        // constant macro arguments of the next call, written in one command.
+        std::string _macroCompound;
+
+        // the last tellraw, a message right after it to the same players is added to it.
+        std::string _lastSelector;
+        std::vector<mc_text> _lastMessage;
+        mc_command _lastMessageCommand{false, 0, ""};
+        // a register the byte code never uses. which of its registers are free isn't known here,
+        // a register freed by one operation can still hold the left side of the next.
+        sharedt<rbc_register> _scratch;
+
         mccmdlist commands;
         mc_program& context;
         rbc_program& rbc_compiler;
         
         
         _This op_reg_math(rbc_register& reg, rbc_value& val, bst_operation_type t);
+        _This op_reg_const_math(rbc_register& reg, int c, bst_operation_type t);
+        _This fixed_reg_math(rbc_register& reg, rbc_value& val, bst_operation_type t);
+        _This rescale(rbc_register& reg, int scale);
+        // for an operand that has to be on the scoreboard, see _scratch.
+        rbc_register& scratchRegister();
         inline _This nop_reg_math(rbc_register& reg, rbc_value& val, bst_operation_type t)
         {
             WARN("Non operable register math is not supported.");
@@ -269,6 +317,10 @@ namespace conversion
 
         CommandFactory(mc_program& _context, rbc_program& _rbc_compiler) : context(_context), rbc_compiler(_rbc_compiler)
         {}
+        inline bool supports(mc_feature feature) const
+        {
+            return context.target.supports(feature);
+        }
         inline void add(mc_command& c)
         { 
             make(c);
@@ -277,6 +329,10 @@ namespace conversion
             else 
                 commands.push_back(c);
         }
+        inline void add(mc_command&& c)
+        {
+            add(c);
+        }
         template<typename... Tys>
         inline void create_and_push(Tys&&... t)
         {
@@ -297,6 +353,17 @@ namespace conversion
         {
             commands.pop_back();
         }
+        // takes the commands out, so a block can be converted on its own in between.
+        inline mccmdlist detach()
+        {
+            mccmdlist c = std::move(commands);
+            commands.clear();
+            return c;
+        }
+        inline void reattach(mccmdlist& c)
+        {
+            commands = std::move(c);
+        }
 #pragma region buffer
         inline void createBuffer()
         {if(!_buffer) _buffer = std::make_shared<mccmdlist>();}
@@ -323,18 +390,73 @@ namespace conversion
         _This appendStorage  (const std::string& dest, const std::string& _const);
         _This createVariable (rs_variable& var);
         _This createVariable (rs_variable& var, rbc_value& val);
+        _This allocateVariable(rs_variable& var, const bool typed = true, const std::string& value = "0");
+        static std::string emptyValue(const rs_variable& var);
+        _This loadVariable   (rs_variable& var, rbc_value* val);
+        _This enterScope     ();
+        _This leaveScope     ();
+        _This leaveFrame     ();
+        _This countStorage   ();
+        _This uncacheSelectors();
+        _This message         (const std::string& selector, const std::vector<mc_text>& parts, bool macro);
+        _This returnResult    (mc_command cmd, bool result = true);
+        _This returnConstant  (int value);
+        std::string useMath   (const std::string& name);
+        _This mathLibrary     (const std::string& module);
+        std::string useList   (const std::string& name);
+        _This listElement     (rs_variable& var, const bool store);
+        _This listLibrary     ();
+        mc_command removeFirst    (rs_variable& list);
+        mc_command whileNotEmpty  (rs_variable& list, const std::string& call);
+        _This forObject       (rs_variable& object, rs_variable& item, rs_object& type, const std::string& call);
+        static mccmdlist mapCommands(const std::string& op, const std::string& map, const std::string& key, const std::string& source, const bool macro);
+        std::string useMap    (const std::string& name);
+        _This mapLibrary      ();
+        bool  scoredHandle    (const rs_variable& var);
+        std::string useHeap   (const std::string& name);
+        _This heapArgument    (rbc_value& handle);
+        _This heapArgument    (rs_variable& handle);
+        _This freeHandles     (size_t from);
+        _This heapLibrary     (const std::string& module);
+        _This schedule        (rbc_function& func, const std::string& ticks);
         _This math           (rbc_value& lhs, rbc_value& rhs, bst_operation_type t);
+        bool  operateScore   (rs_variable& var, rbc_value& val, bst_operation_type t);
         _This pushParameter  (const std::string&, rbc_value& val);
         _This popParameter   ();
         _This invoke         (const std::string& module, rbc_function& func);
         _This Return         (bool val);
+        _This project        (rs_variable& var, const std::string& selector);
+        _This allocateSlot   (rs_variable& param);
+        _This storeReturn    (rs_variable& var);
+        _This allocateMacroSlot(rbc_function& func, rs_variable& param);
+        _This allocateFrameSlot(rbc_function& func, rs_variable& param, uint id);
+        _This suspendFrame   (uint asyncId, const std::string& next);
+        _This resumeFrame    (uint asyncId);
+        _This enqueue        (rbc_function& func, rbc_value& arg);
+        _This startJob       (const std::string& module, rbc_function& func, uint cost);
+        _This macroArgument  (rs_variable& param, rbc_value& val);
+        _This passMacroArguments(rbc_function& func);
+        static bool prefersMacroCall(uint commandUses);
         std::shared_ptr<comparison_register> compareNull    (const bool scoreboard, const std::string& where, const bool eq);
         std::shared_ptr<comparison_register> compare        (const std::string& locationType, const std::string& lhs, const bool eq, const std::string& rhs, const bool rhsIsConstant = false);
+        std::string testRegister(comparison_register& reg, const bool negate = false);
+        // pools a constant, returning the value its fake player is named after.
+        std::string constant(int value);
 
         std::shared_ptr<comparison_register> getFreeComparisonRegister();
         static mc_command makeCopyStorage (const std::string& dest, const std::string& src);
-        static mc_command getVariableValue(rs_variable& var);
+        static std::string functionPath   (const std::string& module, const std::vector<std::string>& modulePath,
+                                           const std::string& parentHashStr, const std::string& name);
+        mc_command getVariableValue(rs_variable& var, int scale = 1);
+        std::string variablePath    (rs_variable& var);
+        std::string variableTypePath(rs_variable& var);
+        int         stackOffset     (rs_variable& var);
+        bool        stacks          (rs_variable& var);
+        static bool        dynamicallyTyped(const rs_variable& var);
         static mc_command getRegisterValue(rbc_register& reg);
+        // the register written to storage, as a double if fixed (floats), otherwise as an int.
+        static mc_command storeRegister   (rbc_register& reg, const std::string& path, const bool fixed);
+        static int        fixedScale      (const rs_type_info& type);
         static mc_command getStackValue   (long index);
         _This             setRegisterValue(rbc_register& reg, rbc_value& c);
         _This             setVariableValue(rs_variable& var, rbc_value& val);
@@ -342,4 +464,4 @@ namespace conversion
 }
 
 
-mc_program tomc(rbc_program&, const std::string&, std::string&);
+mc_program tomc(rbc_program&, const std::string&, std::string&, const mc_target&);
@@ -67,9 +67,13 @@ enum class token_type
     KW_IN,
     KW_BREAK,
     KW_CONTINUE,
+    KW_YIELD,
+    KW_AWAIT,
 
     KW_ASM,
     KW_NULL,
+    KW_AS,
+    KW_AT,
 
     LINE_END
 